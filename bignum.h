@@ -8,7 +8,12 @@
 #  include <inttypes.h>
 #endif
 #include <math.h>
+#include <string.h>
 #include <algorithm>
+#include <string>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 typedef uint_fast16_t len_type;
 typedef uint32_t      digit_type;
@@ -18,8 +23,63 @@ typedef uint8_t       dec_digit_type;
 typedef uint_fast8_t  pow_exp_type;
 #define LEN_TYPE_MAX UINT_FAST16_MAX
 #define DIGIT_TYPE_MAX UINT32_MAX
+#define OPERATION_TYPE_MAX UINT_FAST64_MAX
 #define DEC_LEN_TYPE_MAX UINT_FAST16_MAX
 #define LEN_TYPE_MAX_MASK (((len_type)1)<<15)
+// count of source digits from which conversion between bases
+// which are not powers of one another switches
+// from Horner's method to divide and conquer
+#ifndef RADIX_DC_THRESHOLD
+#  define RADIX_DC_THRESHOLD 32
+#endif
+
+// size of buffer for chunks of decimal representation passed to writer
+#ifndef DEC_WRITE_BUFFER_SIZE
+#  define DEC_WRITE_BUFFER_SIZE 4096
+#endif
+
+#ifdef __SIZEOF_INT128__
+// type for intermediate operations which do not fit in operation_type
+typedef unsigned __int128 wide_operation_type;
+#  define HAVE_WIDE_OPERATION_TYPE
+#endif
+
+// length of shorter factor from which multiplication switches
+// from row-wise to column-wise (comba) kernel
+#ifndef MUL_COMBA_THRESHOLD
+#  define MUL_COMBA_THRESHOLD 2
+#endif
+
+// crossover points of algorithms for BASE
+// specialized for the host by bignum_tuning.h generated by `make tune`
+#ifndef BIGNUM_TUNING_STORAGE
+#  define BIGNUM_TUNING_STORAGE static constexpr
+#endif
+template<operation_type BASE>
+struct BigNumTuning {
+	BIGNUM_TUNING_STORAGE len_type mul_comba_threshold = MUL_COMBA_THRESHOLD;
+	BIGNUM_TUNING_STORAGE len_type radix_dc_threshold = RADIX_DC_THRESHOLD;
+};
+#if !defined(BIGNUM_NO_TUNING_HEADER) && __has_include("bignum_tuning.h")
+#  include "bignum_tuning.h"
+#endif
+// digit (limb) type for BASE: smallest unsigned type which can store BASE-1
+// may be specialized, views, spans and serialized records of BASE use it
+template<operation_type BASE>
+struct BigNumLimb {
+	typedef typename std::conditional<BASE - 1 <= UINT8_MAX, uint8_t,
+		typename std::conditional<BASE - 1 <= UINT16_MAX, uint16_t, uint32_t>::type
+	>::type type;
+};
+
+// type of stored length of bignumber: smallest unsigned type which can store MAX_LEN
+// length in operations is len_type
+template<len_type MAX_LEN>
+struct BigNumLength {
+	typedef typename std::conditional<MAX_LEN <= UINT8_MAX, uint8_t,
+		typename std::conditional<MAX_LEN <= UINT16_MAX, uint16_t, len_type>::type
+	>::type type;
+};
 #ifndef NDEBUG
 #  define LEN_PRINT "%" PRIuFAST16
 #  define DIGIT_PRINT "%" PRIu32
@@ -33,6 +93,14 @@ constexpr pow_exp_type log_floor_constexpr(operation_type base, operation_type p
 	);
 }
 
+constexpr operation_type pow_constexpr(operation_type base, pow_exp_type exp) {
+	return (
+		exp == 0 ?
+		1 :
+		pow_constexpr(base, exp-1) * base
+	);
+}
+
 constexpr bool exact_pow_constexpr(operation_type base, operation_type pow) {
 	return (
 		pow % base != 0 ?
@@ -45,6 +113,168 @@ constexpr bool exact_pow_constexpr(operation_type base, operation_type pow) {
 	);
 }
 
+// a^exp mod m, m < 2^32
+inline operation_type bignum_pow_mod_digit(operation_type a, operation_type exp, const operation_type m) {
+	operation_type result = 1;
+	for (a %= m; exp > 0; exp >>= 1) {
+		if (exp & 1) result = result * a % m;
+		a = a * a % m;
+	}
+	return result;
+}
+
+// deterministic Miller-Rabin for n < 2^32
+inline bool bignum_is_prime_digit(const operation_type n) {
+	if (n < 2) return false;
+	if (n % 2 == 0) return n == 2;
+	operation_type d = n - 1;
+	unsigned int r = 0;
+	for (; d % 2 == 0; d /= 2) ++r;
+	static const operation_type bases[] = {2, 7, 61};
+	for (operation_type a : bases) {
+		if (a % n == 0) continue;
+		operation_type x = bignum_pow_mod_digit(a, d, n);
+		if (x == 1 || x == n - 1) continue;
+		unsigned int i;
+		for (i=1; i<r; ++i) {
+			x = x * x % n;
+			if (x == n - 1) break;
+		}
+		if (i == r) return false;
+	}
+	return true;
+}
+
+// binary serialization: record header, followed by len digits of
+// sizeof(digit_type) bytes each, padded with zeros to a multiple of 8 bytes
+// magic is a byte string, other fields are stored in byte order given by endian
+struct bignum_binary_header {
+	char     magic[4];
+	uint8_t  endian;
+	uint8_t  digit_size;
+	uint16_t reserved0;
+	uint64_t base;
+	uint32_t len;
+	uint32_t reserved1;
+};
+static_assert(sizeof(bignum_binary_header) == 24, "bignum_binary_header has padding");
+#define BIGNUM_BINARY_MAGIC "BNUM"
+#define BIGNUM_BINARY_ALIGN 8
+#define BIGNUM_ENDIAN_LITTLE 1
+#define BIGNUM_ENDIAN_BIG 2
+
+inline uint8_t bignum_native_endian() {
+	const uint16_t probe = 1;
+	return (*(const uint8_t *)&probe == 1 ? BIGNUM_ENDIAN_LITTLE : BIGNUM_ENDIAN_BIG);
+}
+
+// decimal digits of 00 .. 99
+constexpr char bignum_dec_pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// count of decimal digits of v, 1 for 0
+inline pow_exp_type bignum_dec_width(operation_type v) {
+	pow_exp_type width = 1;
+	while (v >= 10) {
+		v /= 10;
+		++width;
+	}
+	return width;
+}
+
+// writes exactly width decimal digits of v with leading zeros
+inline void bignum_write_dec_fixed(char *dest, operation_type v, pow_exp_type width) {
+	while (width >= 2) {
+		const char *pair = bignum_dec_pairs + (v % 100) * 2;
+		dest[width-2] = pair[0];
+		dest[width-1] = pair[1];
+		v /= 100;
+		width -= 2;
+	}
+	if (width == 1) dest[0] = '0' + v % 10;
+}
+
+template<typename T>
+T bignum_byte_swap(T v) {
+	T res = 0;
+	for (size_t i=0; i<sizeof(T); ++i) {
+		res = (res << 8) | (v & 0xFF);
+		v >>= 8;
+	}
+	return res;
+}
+
+// size of serialized record with len digits of digit_size bytes
+inline size_t bignum_binary_size(const size_t len, const size_t digit_size) {
+	size_t size = sizeof(bignum_binary_header) + len * digit_size;
+	return (size + BIGNUM_BINARY_ALIGN - 1) / BIGNUM_BINARY_ALIGN * BIGNUM_BINARY_ALIGN;
+}
+
+// digits of record are normalised: all < base, no leading zero
+template<typename T>
+inline bool bignum_binary_digits_valid(const T *digits, const size_t len, const uint64_t base) {
+	for (size_t i=0; i<len; ++i) {
+		if (digits[i] >= base) return false;
+	}
+	return (len == 0 || digits[len-1] != 0);
+}
+
+// non-owning read-only bignumber: digits are stored elsewhere
+template<operation_type BASE>
+struct BigNumView {
+	typedef typename BigNumLimb<BASE>::type digit_type;
+	
+	const digit_type *digits;
+	len_type len;
+	
+	// returns: <0, 0 or >0 like strcmp
+	static constexpr int compare(const BigNumView &a, const BigNumView &b) {
+		if (a.len != b.len) return (a.len < b.len ? -1 : 1);
+		if (a.len == 0) return 0;
+		for (len_type i=a.len-1;; --i) {
+			if (a.digits[i] < b.digits[i]) return -1;
+			if (a.digits[i] > b.digits[i]) return 1;
+			if (i == 0) break;
+		}
+		return 0;
+	}
+	
+	constexpr bool operator <(const BigNumView &b) const {
+		return compare(*this, b) < 0;
+	}
+	
+	constexpr bool operator <=(const BigNumView &b) const {
+		return compare(*this, b) <= 0;
+	}
+	
+	constexpr bool operator >(const BigNumView &b) const {
+		return compare(*this, b) > 0;
+	}
+	
+	constexpr bool operator >=(const BigNumView &b) const {
+		return compare(*this, b) >= 0;
+	}
+	
+	constexpr bool operator ==(const BigNumView &b) const {
+		return compare(*this, b) == 0;
+	}
+	
+	constexpr bool operator !=(const BigNumView &b) const {
+		return compare(*this, b) != 0;
+	}
+};
+
+// non-owning writable digits buffer for results of static operations
+template<operation_type BASE>
+struct BigNumSpan {
+	typedef typename BigNumLimb<BASE>::type digit_type;
+	
+	digit_type *digits;
+	len_type capacity;
+};
+
+template<class UnsignedBigNum>
+class SignedBigNum;
+
 template<
 	operation_type BASE,
 	len_type MAX_LEN,
@@ -63,23 +293,47 @@ template<
 	)
 >
 class BigNum {
+public:
+	typedef typename BigNumLimb<BASE>::type digit_type;
+	
+private:
 	static_assert(BASE > 1, "BASE is too small");
-	static_assert(BASE - 1 <= DIGIT_TYPE_MAX, "BASE is too large");
+	// limbs are at most 32 bits, (BASE-1)^2 must fit in operation_type
+	static_assert(BASE - 1 <= UINT32_MAX, "BASE is too large");
+	static_assert(BASE - 1 <= std::numeric_limits<digit_type>::max(), "BigNumLimb<BASE> is too small");
 	static_assert(MAX_LEN > 0, "MAX_LEN is too small");
 	static_assert(MAX_LEN < LEN_TYPE_MAX, "MAX_LEN is too large");
 	static_assert(IS_BASE_DECIMAL == !(MAX_DECIMAL_LEN > 0), "MAX_DECIMAL_LEN is wrong");
 	static_assert(IS_BASE_DECIMAL == (BASE_DECIMAL_LEN > 0), "BASE_DECIMAL_LEN is wrong");
 	static_assert(MAX_DECIMAL_LEN < DEC_LEN_TYPE_MAX, "MAX_DECIMAL_LEN is too large");
 	
+public:
+	static constexpr operation_type base = BASE;
+	static constexpr len_type max_len = MAX_LEN;
+	
 private:
 	digit_type digits[MAX_LEN];
-	len_type len;
+	typename BigNumLength<MAX_LEN>::type len;
+	
+	template<operation_type B, len_type L, bool ID, dec_len_type DL, pow_exp_type BDL>
+	friend class BigNum;
+	
+	// digits above len are left uninitialized, but result of constant expression
+	// must not contain indeterminate values
+	constexpr void init_digits() {
+		if (std::is_constant_evaluated()) {
+			for (len_type i=0; i<MAX_LEN; ++i) digits[i] = 0;
+		}
+	}
 	
 public:
-	BigNum() : len(0) {}
+	constexpr BigNum() : len(0) {
+		init_digits();
+	}
 	
 	// n may be > BASE
-	BigNum(operation_type n) {
+	constexpr BigNum(operation_type n) {
+		init_digits();
 		// TODO: not efficient if always n < BASE
 		len_type i = 0;
 		while (n > 0) {
@@ -91,35 +345,36 @@ public:
 	}
 	
 private:
-	void assign(const len_type b_len, const digit_type b_digits[]) {
+	constexpr void assign(const len_type b_len, const digit_type b_digits[]) {
 		assert(b_len <= MAX_LEN);
 		len = b_len;
 		std::copy(b_digits, b_digits+b_len, digits);
 	}
 	
-	void assign(const BigNum &b) {
+	constexpr void assign(const BigNum &b) {
 		assign(b.len, b.digits);
 	}
 	
 public:
-	BigNum(const len_type b_len, const digit_type b_digits[]) {
+	constexpr BigNum(const len_type b_len, const digit_type b_digits[]) {
+		init_digits();
 		assign(b_len, b_digits);
 	}
 	
-	BigNum(const BigNum &b) : BigNum(b.len, b.digits) {}
+	constexpr BigNum(const BigNum &b) : BigNum(b.len, b.digits) {}
 	
-	BigNum(BigNum &&b) : BigNum(b.len, b.digits) {
+	constexpr BigNum(BigNum &&b) : BigNum(b.len, b.digits) {
 		b.len = 0;
 	}
 	
-	BigNum& operator=(const BigNum &b) {
+	constexpr BigNum& operator=(const BigNum &b) {
 		if (this != &b) {
 			assign(b);
 		}
 		return *this;
 	}
 	
-	BigNum& operator=(BigNum &&b) {
+	constexpr BigNum& operator=(BigNum &&b) {
 		if (this != &b) {
 			assign(b);
 			b.len = 0;
@@ -127,24 +382,130 @@ public:
 		return *this;
 	}
 	
+private:
+	// B^(2^k) in this BASE for divide and conquer radix conversion
+	template<operation_type B>
+	struct RadixPowers {
+		BigNum pow[sizeof(len_type) * 8];
+		pow_exp_type count;
+		
+		// all powers which fit in MAX_LEN
+		RadixPowers() : count(1) {
+			pow[0] = B;
+			while (count < sizeof(len_type) * 8 && (size_t)pow[count-1].len * 2 - 1 <= MAX_LEN) {
+				const BigNum<BASE, MAX_LEN + MAX_LEN> square = pow[count-1].mul_wide(pow[count-1]);
+				if (square.view().len > MAX_LEN) break;
+				pow[count] = BigNum(square.view());
+				++count;
+			}
+		}
+	};
+	
+	// computed once per pair of bases
+	template<operation_type B>
+	static const RadixPowers<B>& radix_powers() {
+		static const RadixPowers<B> powers;
+		return powers;
+	}
+	
+	// result = value of b.digits[lo .. lo+n) in base B
+	template<operation_type B>
+	static void radix_convert(BigNum &result, const BigNumView<B> b, const len_type lo, len_type n) {
+		// high zero digits of low parts
+		while (n > 0 && b.digits[lo+n-1] == 0) --n;
+		// n = h + (n - h), h = 2^k < n
+		pow_exp_type k = 0;
+		while (((len_type)2 << k) < n) ++k;
+		const len_type h = (len_type)1 << k;
+		const RadixPowers<B> &powers = radix_powers<B>();
+		// B^h <= value fits unless value does not fit
+		if (n <= BigNumTuning<BASE>::radix_dc_threshold || k >= powers.count) {
+			result.len = 0;
+			for (len_type i=lo+n; i>lo; --i) {
+				result.len = mul_static(result.span(), result, B);
+				result.len = add_static(result.span(), result, (operation_type)b.digits[i-1]);
+			}
+			return;
+		}
+		BigNum part;
+		radix_convert(part, b, lo + h, n - h);
+		result.len = mul_static(result.span(), part, powers.pow[k]);
+		radix_convert(part, b, lo, h);
+		result += part;
+	}
+	
+	template<operation_type B>
+	void assign_radix(const BigNumView<B> b) {
+		if constexpr (B == BASE) {
+			assign(b.len, b.digits);
+		} else if (B < BASE && exact_pow_constexpr(B, BASE)) {
+			// each digit is a group of k source digits
+			const pow_exp_type k = log_floor_constexpr(B, BASE);
+			const len_type result_len = (b.len + k - 1) / k;
+			assert(result_len <= MAX_LEN);
+			len = result_len;
+			for (len_type i=0; i<len; ++i) {
+				operation_type d = 0;
+				for (len_type j=std::min<len_type>(b.len, (i+1)*k); j>i*k; --j) {
+					d = d * B + b.digits[j-1];
+				}
+				digits[i] = d;
+			}
+		} else if (B > BASE && exact_pow_constexpr(BASE, B)) {
+			// each source digit is split into k digits
+			const pow_exp_type k = log_floor_constexpr(BASE, B);
+			len = 0;
+			for (len_type i=0; i<b.len; ++i) {
+				operation_type d = b.digits[i];
+				for (pow_exp_type j=0; j<k; ++j) {
+					const len_type pos = i * k + j;
+					if (pos < MAX_LEN) digits[pos] = d % BASE;
+					else assert(d % BASE == 0);
+					if (d % BASE != 0) len = pos + 1;
+					d /= BASE;
+				}
+			}
+		} else {
+			radix_convert(*this, b, 0, b.len);
+		}
+	}
+	
+public:
+	// value of view in any base
+	template<operation_type B>
+	explicit BigNum(const BigNumView<B> &b) {
+		assign_radix(b);
+	}
+	
+	// converts value if B != BASE
 	template<operation_type B, len_type L, bool ID, dec_len_type DL, pow_exp_type BDL>
-	BigNum<B, L, ID, DL, BDL> clone_template() const {
-		return BigNum<B, L, ID, DL, BDL>(len, digits);
+	BigNum(const BigNum<B, L, ID, DL, BDL> &b) {
+		assign_radix(b.view());
 	}
 	
 	template<operation_type B, len_type L, bool ID, dec_len_type DL, pow_exp_type BDL>
-	BigNum(const BigNum<B, L, ID, DL, BDL> &b) :
-		BigNum(
-			b.clone_template<
-				BASE,
-				MAX_LEN,
-				IS_BASE_DECIMAL,
-				MAX_DECIMAL_LEN,
-				BASE_DECIMAL_LEN
-			>()
-		) {}
-	
-	operation_type value() const {
+	BigNum<B, L, ID, DL, BDL> clone_template() const {
+		return BigNum<B, L, ID, DL, BDL>(*this);
+	}
+	
+	constexpr BigNumView<BASE> view() const {
+		BigNumView<BASE> v = {digits, len};
+		return v;
+	}
+	
+	constexpr operator BigNumView<BASE>() const {
+		return view();
+	}
+	
+private:
+	constexpr BigNumSpan<BASE> span() {
+		BigNumSpan<BASE> s = {digits, MAX_LEN};
+		return s;
+	}
+	
+public:
+	
+	constexpr operation_type value() const {
 		if (len == 0) return 0;
 		operation_type n = 0;
 		for (len_type i=len-1;; --i) {
@@ -155,16 +516,16 @@ public:
 		return n;
 	}
 	
-	static void swap(BigNum &a, BigNum &b) {
+	static constexpr void swap(BigNum &a, BigNum &b) {
 		BigNum tmp(a); a = b; b = tmp;
 	}
 	
 	#ifndef NDEBUG
 	void fdump(FILE *stream) const {
-		fprintf(stream, LEN_PRINT "[", len);
+		fprintf(stream, LEN_PRINT "[", (len_type)len);
 		if (len > 0) {
 			for (len_type i=len-1;; --i) {
-				fprintf(stream, DIGIT_PRINT, digits[i]);
+				fprintf(stream, DIGIT_PRINT, (::digit_type)digits[i]);
 				if (i != 0) fprintf(stream, " ");
 				else break;
 			}
@@ -177,163 +538,217 @@ public:
 	}
 	#endif
 	
-	// print decimal
-	void fprintd(FILE *stream) const {
+private:
+	// calls put(v, width) for decimal limbs (groups of decimal digits) from the most significant one,
+	// width is the count of decimal digits in limb or 0 for the most significant limb
+	template<class Put>
+	void for_each_decimal_limb(Put put) const {
 		if (len == 0) {
-			fputc('0', stream);
+			put(0, 0);
 			return;
 		}
-		if (IS_BASE_DECIMAL) {
-			digit_type cur, dec_digit_mask, dec_digit;
-			bool leading_zeros = true;
-			for (len_type i=len-1;; --i) {
-				cur = digits[i];
-				dec_digit_mask = BASE / 10;
-				for (pow_exp_type j=0; j<BASE_DECIMAL_LEN; ++j) {
-					dec_digit = cur / dec_digit_mask;
-					assert(dec_digit < 10);
-					cur %= dec_digit_mask;
-					dec_digit_mask /= 10;
-					if (leading_zeros) leading_zeros = (dec_digit == 0);
-					if (!leading_zeros)
-						fputc(dec_digit + '0', stream);
-				}
-				assert(dec_digit_mask == 0);
-				assert(cur == 0);
-				if (i == 0) break;
-			}
-		} else if (BASE > 10) {
-			BigNum cur(*this);
-			dec_digit_type decimal[MAX_DECIMAL_LEN];
-			dec_len_type i = 0;
-			digit_type remaind;
-			while (cur > 0) {
-				assert(i < MAX_DECIMAL_LEN);
-				cur = cur.div(10, &remaind);
-				decimal[i++] = remaind;
-			}
-			assert(i > 0);
-			--i;
-			while (true) {
-				fputc(decimal[i] + '0', stream);
-				if (i == 0) break;
-				--i;
-			}
+		if constexpr (IS_BASE_DECIMAL) {
+			put(digits[len-1], 0);
+			for (len_type i=len-1; i>0; --i) put(digits[i-1], BASE_DECIMAL_LEN);
 		} else {
-			// TODO
-			static_assert(BASE >= 10, "BASE is less than 10");
+			BigNum<1000000000, MAX_DECIMAL_LEN / 9 + 1> decimal(*this);
+			decimal.for_each_decimal_limb(put);
 		}
 	}
 	
+public:
+	// writes decimal representation into [first, last) without terminating zero
+	// returns: pointer past the last written char or NULL if buffer is too small
+	char* to_chars(char *first, char *last) const {
+		bool fits = true;
+		for_each_decimal_limb([&](operation_type v, pow_exp_type width) {
+			if (width == 0) width = bignum_dec_width(v);
+			if (!fits || last - first < width) {
+				fits = false;
+				return;
+			}
+			bignum_write_dec_fixed(first, v, width);
+			first += width;
+		});
+		return (fits ? first : NULL);
+	}
+	
+	std::string to_string() const {
+		std::string result;
+		write_decimal([&result](const char *data, size_t size) {
+			result.append(data, size);
+		});
+		return result;
+	}
+	
+	// calls writer(const char *data, size_t size) for consecutive chunks
+	// of decimal representation, at most DEC_WRITE_BUFFER_SIZE chars each
+	template<class Writer>
+	void write_decimal(Writer writer) const {
+		static_assert(DEC_WRITE_BUFFER_SIZE >= 20, "DEC_WRITE_BUFFER_SIZE is too small");
+		char buffer[DEC_WRITE_BUFFER_SIZE];
+		size_t used = 0;
+		for_each_decimal_limb([&](operation_type v, pow_exp_type width) {
+			if (width == 0) width = bignum_dec_width(v);
+			if (used + width > sizeof(buffer)) {
+				writer((const char *)buffer, used);
+				used = 0;
+			}
+			bignum_write_dec_fixed(buffer + used, v, width);
+			used += width;
+		});
+		if (used > 0) writer((const char *)buffer, used);
+	}
+	
+	// print decimal
+	void fprintd(FILE *stream) const {
+		write_decimal([stream](const char *data, size_t size) {
+			fwrite(data, 1, size, stream);
+		});
+	}
+	
 	// print decimal
 	void printd() const {
 		fprintd(stdout);
 	}
 	
-	bool operator <(const digit_type b) const {
-		assert(b < BASE);
+	size_t binary_size() const {
+		return bignum_binary_size(len, sizeof(digit_type));
+	}
+	
+	// write binary record in native byte order
+	// returns: success
+	bool fwrite_binary(FILE *stream) const {
+		bignum_binary_header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, BIGNUM_BINARY_MAGIC, sizeof(header.magic));
+		header.endian = bignum_native_endian();
+		header.digit_size = sizeof(digit_type);
+		header.base = BASE;
+		header.len = len;
+		if (fwrite(&header, sizeof(header), 1, stream) != 1) return false;
+		if (fwrite(digits, sizeof(digit_type), len, stream) != len) return false;
+		const size_t padding = binary_size() - sizeof(header) - len * sizeof(digit_type);
+		const uint8_t zeros[BIGNUM_BINARY_ALIGN] = {0};
+		return fwrite(zeros, 1, padding, stream) == padding;
+	}
+	
+	// read binary record written on machine with any byte order
+	// record base and digit size must match this BigNum
+	// on failure bignumber is set to 0
+	// returns: success
+	bool fread_binary(FILE *stream) {
+		len = 0;
+		bignum_binary_header header;
+		if (fread(&header, sizeof(header), 1, stream) != 1) return false;
+		if (memcmp(header.magic, BIGNUM_BINARY_MAGIC, sizeof(header.magic)) != 0) return false;
+		if (header.endian != BIGNUM_ENDIAN_LITTLE && header.endian != BIGNUM_ENDIAN_BIG) return false;
+		const bool swap_bytes = (header.endian != bignum_native_endian());
+		if (swap_bytes) {
+			header.base = bignum_byte_swap(header.base);
+			header.len = bignum_byte_swap(header.len);
+		}
+		if (header.digit_size != sizeof(digit_type)) return false;
+		if (header.base != BASE || header.len > MAX_LEN) return false;
+		const len_type b_len = header.len;
+		if (fread(digits, sizeof(digit_type), b_len, stream) != b_len) return false;
+		const size_t padding = bignum_binary_size(b_len, sizeof(digit_type)) - sizeof(header) - b_len * sizeof(digit_type);
+		uint8_t zeros[BIGNUM_BINARY_ALIGN];
+		if (fread(zeros, 1, padding, stream) != padding) return false;
+		if (swap_bytes) {
+			for (len_type i=0; i<b_len; ++i) digits[i] = bignum_byte_swap(digits[i]);
+		}
+		if (!bignum_binary_digits_valid(digits, b_len, BASE)) return false;
+		len = b_len;
+		return true;
+	}
+	
+private:
+	// returns: <0, 0 or >0 like strcmp, b may not fit in bignum
+	static constexpr int compare_scalar(const BigNumView<BASE> a, operation_type b) {
+		digit_type b_digits[sizeof(operation_type) * 8] = {};
+		len_type b_len = 0;
+		for (; b > 0; b /= BASE) b_digits[b_len++] = b % BASE;
+		const BigNumView<BASE> bv = {b_digits, b_len};
+		return BigNumView<BASE>::compare(a, bv);
+	}
+	
+public:
+	// b may be > BASE
+	constexpr bool operator <(const operation_type b) const {
+		if (b >= BASE) return compare_scalar(*this, b) < 0;
 		if (len > 1) return false;
 		if (len == 1) return digits[0] < b;
 		return 0 < b; // if (len == 0)
 	}
 	
-	bool operator <=(const digit_type b) const {
-		assert(b < BASE);
+	// b may be > BASE
+	constexpr bool operator <=(const operation_type b) const {
+		if (b >= BASE) return compare_scalar(*this, b) <= 0;
 		if (len > 1) return false;
 		if (len == 1) return digits[0] <= b;
 		return true; // if (len == 0)
 	}
 	
-	bool operator >(const digit_type b) const {
-		assert(b < BASE);
+	// b may be > BASE
+	constexpr bool operator >(const operation_type b) const {
+		if (b >= BASE) return compare_scalar(*this, b) > 0;
 		if (len > 1) return true;
 		if (len == 1) return digits[0] > b;
 		return false; // if (len == 0)
 	}
 	
-	bool operator >=(const digit_type b) const {
-		assert(b < BASE);
+	// b may be > BASE
+	constexpr bool operator >=(const operation_type b) const {
+		if (b >= BASE) return compare_scalar(*this, b) >= 0;
 		if (len > 1) return true;
 		if (len == 1) return digits[0] >= b;
 		return 0 >= b; // if (len == 0)
 	}
 	
-	bool operator ==(const digit_type b) const {
-		assert(b < BASE);
+	// b may be > BASE
+	constexpr bool operator ==(const operation_type b) const {
+		if (b >= BASE) return compare_scalar(*this, b) == 0;
 		if (len > 1) return false;
 		if (len == 1) return digits[0] == b;
 		return 0 == b; // if (len == 0)
 	}
 	
-	bool operator !=(const digit_type b) const {
-		assert(b < BASE);
+	// b may be > BASE
+	constexpr bool operator !=(const operation_type b) const {
+		if (b >= BASE) return compare_scalar(*this, b) != 0;
 		if (len > 1) return true;
 		if (len == 1) return digits[0] != b;
 		return 0 != b; // if (len == 0)
 	}
 	
-	bool operator <(const BigNum &b) const {
-		if (len != b.len) return len < b.len;
-		if (len == 0) return false;
-		for (len_type i=len-1;; --i) {
-			if (digits[i] < b.digits[i]) return true;
-			if (digits[i] > b.digits[i]) return false;
-			if (i == 0) break;
-		}
-		return false;
+	constexpr bool operator <(const BigNumView<BASE> &b) const {
+		return BigNumView<BASE>::compare(view(), b) < 0;
 	}
 	
-	bool operator <=(const BigNum &b) const {
-		if (len != b.len) return len < b.len;
-		if (len == 0) return true;
-		for (len_type i=len-1;; --i) {
-			if (digits[i] < b.digits[i]) return true;
-			if (digits[i] > b.digits[i]) return false;
-			if (i == 0) break;
-		}
-		return true;
+	constexpr bool operator <=(const BigNumView<BASE> &b) const {
+		return BigNumView<BASE>::compare(view(), b) <= 0;
 	}
 	
-	bool operator >(const BigNum &b) const {
-		if (len != b.len) return len > b.len;
-		if (len == 0) return false;
-		for (len_type i=len-1;; --i) {
-			if (digits[i] < b.digits[i]) return false;
-			if (digits[i] > b.digits[i]) return true;
-			if (i == 0) break;
-		}
-		return false;
+	constexpr bool operator >(const BigNumView<BASE> &b) const {
+		return BigNumView<BASE>::compare(view(), b) > 0;
 	}
 	
-	bool operator >=(const BigNum &b) const {
-		if (len != b.len) return len > b.len;
-		if (len == 0) return true;
-		for (len_type i=len-1;; --i) {
-			if (digits[i] < b.digits[i]) return false;
-			if (digits[i] > b.digits[i]) return true;
-			if (i == 0) break;
-		}
-		return true;
+	constexpr bool operator >=(const BigNumView<BASE> &b) const {
+		return BigNumView<BASE>::compare(view(), b) >= 0;
 	}
 	
-	bool operator ==(const BigNum &b) const {
-		if (len != b.len) return false;
-		for (len_type i=0; i<len; ++i) {
-			if (digits[i] != b.digits[i]) return false;
-		}
-		return true;
+	constexpr bool operator ==(const BigNumView<BASE> &b) const {
+		return BigNumView<BASE>::compare(view(), b) == 0;
 	}
 	
-	bool operator !=(const BigNum &b) const {
-		if (len != b.len) return true;
-		for (len_type i=0; i<len; ++i) {
-			if (digits[i] == b.digits[i]) return false;
-		}
-		return true;
+	constexpr bool operator !=(const BigNumView<BASE> &b) const {
+		return BigNumView<BASE>::compare(view(), b) != 0;
 	}
 	
-	// may be result === a
-	static void add_static(BigNum &result, const BigNum &a, const BigNum &b) {
+	// may be result.digits == a.digits or result.digits == b.digits
+	// returns: result length
+	static constexpr len_type add_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const BigNumView<BASE> b) {
 		operation_type overflow = 0;
 		operation_type summ;
 		len_type i;
@@ -343,7 +758,8 @@ public:
 			else {summ -= BASE; overflow = 1;}
 			result.digits[i] = summ;
 		}
-		const BigNum &l = (a.len < b.len ? b : a); // longest
+		const BigNumView<BASE> &l = (a.len < b.len ? b : a); // longest
+		assert(l.len <= result.capacity);
 		for (; i<l.len && overflow > 0; ++i) {
 			summ = (operation_type)l.digits[i] + overflow;
 			if (summ < BASE) {overflow = 0;}
@@ -351,101 +767,256 @@ public:
 			result.digits[i] = summ;
 		}
 		if (overflow == 0) {
-			if (&result == &l) {
+			if (result.digits == l.digits) {
 				i = l.len;
 			} else {
 				for (; i<l.len; ++i) result.digits[i] = l.digits[i];
 			}
 		} else {
-			assert(i < MAX_LEN);
+			assert(i < result.capacity);
 			result.digits[i++] = overflow;
 		}
-		result.len = i;
+		return i;
+	}
+	
+	// may be result === a
+	static constexpr void add_static(BigNum &result, const BigNum &a, const BigNum &b) {
+		result.len = add_static(result.span(), a, b);
 	}
 	
-	BigNum operator+(const BigNum &b) const {
+	constexpr BigNum operator+(const BigNum &b) const {
 		BigNum result;
 		add_static(result, *this, b);
 		return result;
 	}
 	
-	BigNum& operator +=(const BigNum &b) {
+	constexpr BigNum& operator +=(const BigNum &b) {
 		add_static(*this, *this, b);
 		return *this;
 	}
 	
 	// b may be > BASE
-	BigNum operator+(const operation_type b) const {
-		return *this + BigNum(b);
+	// may be result.digits == a.digits
+	// returns: result length
+	static constexpr len_type add_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const operation_type b) {
+		assert(a.len <= result.capacity);
+		operation_type carry = b;
+		operation_type summ;
+		len_type i;
+		for (i = 0; i<a.len && carry > 0; ++i) {
+			summ = (operation_type)a.digits[i] + carry % BASE;
+			carry /= BASE;
+			if (summ >= BASE) {summ -= BASE; ++carry;}
+			result.digits[i] = summ;
+		}
+		if (result.digits == a.digits) {
+			if (i < a.len) i = a.len;
+		} else {
+			for (; i<a.len; ++i) result.digits[i] = a.digits[i];
+		}
+		while (carry > 0) {
+			assert(i < result.capacity);
+			result.digits[i++] = carry % BASE;
+			carry /= BASE;
+		}
+		return i;
+	}
+	
+	// b may be > BASE
+	constexpr BigNum operator+(const operation_type b) const {
+		BigNum result;
+		result.len = add_static(result.span(), *this, b);
+		return result;
 	}
 	
 	// b may be > BASE
-	BigNum& operator +=(const operation_type b) {
-		return *this += BigNum(b);
+	constexpr BigNum& operator +=(const operation_type b) {
+		len = add_static(span(), *this, b);
+		return *this;
 	}
 	
-	// self += b * BASE^exp * coef
-	void add_mul_assign(const BigNum &b, const len_type exp, const operation_type coef) {
+	// result += b * BASE^exp * coef
+	// result has result_len digits, must not overlap b
+	// returns: result length
+	static constexpr len_type add_mul_static(
+		const BigNumSpan<BASE> result, const len_type result_len,
+		const BigNumView<BASE> b, const len_type exp, const operation_type coef
+	) {
 		assert(exp <= b.len + exp); // detect overflow
-		assert(b.len + exp <= MAX_LEN);
+		assert(b.len + exp <= result.capacity);
 		assert(coef < BASE);
-		if (b.len == 0 || coef == 0) return;
+		if (b.len == 0 || coef == 0) return result_len;
 		operation_type overflow = 0;
 		operation_type res;
 		len_type i, j;
-		for (i = len; i<exp; ++i) digits[i] = 0;
-		for (i = exp, j = 0; i<len && j<b.len; ++i, ++j) {
-			res = (operation_type)digits[i] + (operation_type)b.digits[j] * coef + overflow;
-			digits[i] = res % BASE;
+		for (i = result_len; i<exp; ++i) result.digits[i] = 0;
+		for (i = exp, j = 0; i<result_len && j<b.len; ++i, ++j) {
+			res = (operation_type)result.digits[i] + (operation_type)b.digits[j] * coef + overflow;
+			result.digits[i] = res % BASE;
 			overflow = res / BASE;
 		}
 		for (; j<b.len; ++i, ++j) {
 			res = (operation_type)b.digits[j] * coef + overflow;
-			digits[i] = res % BASE;
+			result.digits[i] = res % BASE;
 			overflow = res / BASE;
 		}
-		for (; i<len && overflow > 0; ++i) {
-			res = (operation_type)digits[i] + overflow;
-			digits[i] = res % BASE;
+		for (; i<result_len && overflow > 0; ++i) {
+			res = (operation_type)result.digits[i] + overflow;
+			result.digits[i] = res % BASE;
 			overflow = res / BASE;
 		}
 		if (overflow > 0) {
-			assert(i < MAX_LEN);
-			digits[i++] = overflow;
+			assert(i < result.capacity);
+			result.digits[i++] = overflow;
 		}
-		if (len < i) len = i;
+		return (result_len < i ? i : result_len);
+	}
+	
+	// self += b * BASE^exp * coef
+	constexpr void add_mul_assign(const BigNum &b, const len_type exp, const operation_type coef) {
+		len = add_mul_static(span(), len, b, exp, coef);
 	}
 	
-	BigNum operator*(const BigNum &b) const {
-		assert(len <= len + b.len); // detect overflow
-		assert(len + b.len <= MAX_LEN + 1);
-		BigNum result(0);
+	// result = a * b, row by row: one add_mul_static per digit of b
+	// result must not overlap a and b
+	// returns: result length
+	static constexpr len_type mul_rows_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const BigNumView<BASE> b) {
+		len_type result_len = 0;
 		for (len_type i=0; i<b.len; ++i) {
-			result.add_mul_assign(*this, i, b.digits[i]);
+			result_len = add_mul_static(result, result_len, a, i, b.digits[i]);
+		}
+		return result_len;
+	}
+	
+	// result = a * b, column by column (product scanning):
+	// partial products of column are summed in T, carry is normalised once per column
+	// T must fit min(a.len, b.len) * (BASE-1)^2 + carry
+	// result must not overlap a and b
+	// returns: result length
+	template<typename T>
+	static constexpr len_type mul_columns_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const BigNumView<BASE> b) {
+		if (a.len == 0 || b.len == 0) return 0;
+		const len_type columns = a.len + b.len - 1;
+		T acc = 0;
+		len_type k;
+		for (k = 0; k<columns; ++k) {
+			const len_type i_begin = (k < b.len ? 0 : k - b.len + 1);
+			const len_type i_end = (k < a.len ? k + 1 : a.len);
+			for (len_type i=i_begin; i<i_end; ++i) {
+				acc += (operation_type)a.digits[i] * (operation_type)b.digits[k-i];
+			}
+			assert(k < result.capacity);
+			result.digits[k] = acc % BASE;
+			acc /= BASE;
 		}
+		while (acc > 0) {
+			assert(k < result.capacity);
+			result.digits[k++] = acc % BASE;
+			acc /= BASE;
+		}
+		return k;
+	}
+	
+	// result must not overlap a and b
+	// returns: result length
+	static constexpr len_type mul_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const BigNumView<BASE> b) {
+		assert(a.len <= a.len + b.len); // detect overflow
+		assert(a.len + b.len <= result.capacity + 1);
+		const len_type min_len = std::min(a.len, b.len);
+		if (min_len < BigNumTuning<BASE>::mul_comba_threshold) {
+			return mul_rows_static(result, a, b);
+		}
+		// column sum fits in operation_type for small BASE
+		if (min_len < (OPERATION_TYPE_MAX / (BASE-1) / (BASE-1)) / 2) {
+			return mul_columns_static<operation_type>(result, a, b);
+		}
+	#ifdef HAVE_WIDE_OPERATION_TYPE
+		return mul_columns_static<wide_operation_type>(result, a, b);
+	#else
+		return mul_rows_static(result, a, b);
+	#endif
+	}
+	
+	constexpr BigNum operator*(const BigNum &b) const {
+		BigNum result;
+		result.len = mul_static(result.span(), *this, b);
 		return result;
 	}
 	
-	BigNum& operator *=(const BigNum &b) {
+	constexpr BigNum& operator *=(const BigNum &b) {
 		BigNum result = (*this) * b;
 		(*this) = result;
 		return *this;
 	}
 	
+	// product in bignum wide enough for any product of operands
+	template<len_type L, bool ID, dec_len_type DL, pow_exp_type BDL>
+	constexpr BigNum<BASE, MAX_LEN + L> mul_wide(const BigNum<BASE, L, ID, DL, BDL> &b) const {
+		BigNum<BASE, MAX_LEN + L> result;
+		result.len = mul_static(result.span(), *this, b);
+		return result;
+	}
+	
+private:
+	// T must fit (BASE-1) * b + b
+	template<typename T>
+	static constexpr len_type mul_scalar_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const operation_type b) {
+		T carry = 0;
+		T res;
+		len_type i;
+		for (i = 0; i<a.len; ++i) {
+			res = (T)a.digits[i] * b + carry;
+			result.digits[i] = res % BASE;
+			carry = res / BASE;
+		}
+		while (carry > 0) {
+			assert(i < result.capacity);
+			result.digits[i++] = carry % BASE;
+			carry /= BASE;
+		}
+		return i;
+	}
+	
+public:
 	// b may be > BASE
-	BigNum operator*(const operation_type b) const {
-		return *this * BigNum(b);
+	// may be result.digits == a.digits
+	// returns: result length
+	static constexpr len_type mul_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const operation_type b) {
+		assert(a.len <= result.capacity);
+		if (a.len == 0 || b == 0) return 0;
+		if (b <= OPERATION_TYPE_MAX / BASE) {
+			return mul_scalar_static<operation_type>(result, a, b);
+		}
+	#ifdef HAVE_WIDE_OPERATION_TYPE
+		return mul_scalar_static<wide_operation_type>(result, a, b);
+	#else
+		BigNum product;
+		product.len = mul_static(product.span(), a, BigNum(b));
+		assert(product.len <= result.capacity);
+		std::copy(product.digits, product.digits+product.len, result.digits);
+		return product.len;
+	#endif
 	}
 	
 	// b may be > BASE
-	BigNum& operator *=(const operation_type b) {
-		return *this *= BigNum(b);
+	constexpr BigNum operator*(const operation_type b) const {
+		BigNum result;
+		result.len = mul_static(result.span(), *this, b);
+		return result;
 	}
 	
-	// may be result === a
-	static void sub_static(BigNum &result, const BigNum &a, const BigNum &b) {
+	// b may be > BASE
+	constexpr BigNum& operator *=(const operation_type b) {
+		len = mul_static(span(), *this, b);
+		return *this;
+	}
+	
+	// may be result.digits == a.digits or result.digits == b.digits
+	// returns: result length
+	static constexpr len_type sub_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const BigNumView<BASE> b) {
 		assert(b.len <= a.len);
-		if (a.len == 0) {result.len = 0; return;}
+		assert(a.len <= result.capacity);
+		if (a.len == 0) return 0;
 		operation_type carry = 0;
 		operation_type subtr, res;
 		len_type i, j = 0;
@@ -474,7 +1045,7 @@ public:
 			result.digits[i] = res;
 		}
 		if (i < a.len) {
-			if (&result == &a) {
+			if (result.digits == a.digits) {
 				i = a.len;
 			} else {
 				for (; i<a.len; ++i) result.digits[i] = a.digits[i];
@@ -483,73 +1054,224 @@ public:
 		}
 		assert(carry == 0);
 		assert(i > 0);
-		result.len = j;
+		return j;
+	}
+	
+	// may be result === a or result === b
+	static constexpr void sub_static(BigNum &result, const BigNum &a, const BigNum &b) {
+		result.len = sub_static(result.span(), a, b);
 	}
 	
-	BigNum operator-(const BigNum &b) const {
+	constexpr BigNum operator-(const BigNum &b) const {
 		BigNum result;
 		sub_static(result, *this, b);
 		return result;
 	}
 	
-	BigNum& operator -=(const BigNum &b) {
+	constexpr BigNum& operator -=(const BigNum &b) {
 		sub_static(*this, *this, b);
 		return *this;
 	}
 	
 	// b may be > BASE
-	BigNum operator-(const operation_type b) const {
-		return *this - BigNum(b);
+	// may be result.digits == a.digits
+	// returns: result length
+	static constexpr len_type sub_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const operation_type b) {
+		assert(a.len <= result.capacity);
+		operation_type carry = b;
+		operation_type subtr;
+		len_type i;
+		for (i = 0; i<a.len && carry > 0; ++i) {
+			subtr = carry % BASE;
+			carry /= BASE;
+			if ((operation_type)a.digits[i] >= subtr) {
+				result.digits[i] = (operation_type)a.digits[i] - subtr;
+			} else {
+				result.digits[i] = (operation_type)a.digits[i] + (BASE - subtr);
+				++carry;
+			}
+		}
+		assert(carry == 0);
+		if (i < a.len) {
+			if (result.digits != a.digits) {
+				for (; i<a.len; ++i) result.digits[i] = a.digits[i];
+			}
+			return a.len;
+		}
+		while (i > 0 && result.digits[i-1] == 0) --i;
+		return i;
 	}
 	
 	// b may be > BASE
-	BigNum& operator -=(const operation_type b) {
-		return *this -= BigNum(b);
+	constexpr BigNum operator-(const operation_type b) const {
+		BigNum result;
+		result.len = sub_static(result.span(), *this, b);
+		return result;
 	}
 	
-	// may be result === a
-	static void div_static(BigNum &result, const BigNum &a, const digit_type b, digit_type *remaind) {
-		assert(b < BASE);
-		assert(b > 0);
-		if (a.len == 0) {
-			*remaind = 0;
-			result.len = 0;
-			return;
+	// b may be > BASE
+	constexpr BigNum& operator -=(const operation_type b) {
+		len = sub_static(span(), *this, b);
+		return *this;
+	}
+	
+	// may be result.digits == a.digits
+	// result may be shorter than a if quotient fits in it
+	// returns: result length
+	static constexpr len_type div_static(
+		const BigNumSpan<BASE> result, const BigNumView<BASE> a,
+		const operation_type b, digit_type *remaind
+	) {
+		assert(b < BASE);
+		assert(b > 0);
+		if (a.len == 0) {
+			*remaind = 0;
+			return 0;
 		}
 		len_type result_len = a.len;
 		if (a.digits[a.len-1] < b) --result_len;
+		assert(result_len <= result.capacity);
 		operation_type carry = 0;
 		operation_type res;
 		for (len_type i=a.len-1;; --i) {
 			res = (operation_type)a.digits[i] + carry * BASE;
 			carry = res % b;
-			result.digits[i] = res / b;
-			assert(result.digits[i] < BASE);
+			if (i < result_len) result.digits[i] = res / b;
+			assert(res / b < BASE);
 			if (i == 0) break;
 		}
 		*remaind = carry;
-		result.len = result_len;
+		return result_len;
+	}
+	
+	// may be result === a
+	static constexpr void div_static(BigNum &result, const BigNum &a, const operation_type b, digit_type *remaind) {
+		result.len = div_static(result.span(), a, b, remaind);
 	}
 	
-	BigNum div(const digit_type b, digit_type *remaind) const {
+	constexpr BigNum div(const operation_type b, digit_type *remaind) const {
 		BigNum result;
 		div_static(result, *this, b, remaind);
 		return result;
 	}
 	
-	BigNum operator/(const digit_type b) const {
-		digit_type remaind;
+private:
+	// T must fit b * BASE
+	template<typename T>
+	static constexpr len_type div_scalar_static(
+		const BigNumSpan<BASE> result, const BigNumView<BASE> a,
+		const operation_type b, operation_type *remaind
+	) {
+		T carry = 0;
+		T res;
+		len_type result_len = 0;
+		for (len_type i=a.len-1;; --i) {
+			res = (T)a.digits[i] + carry * BASE;
+			carry = res % b;
+			res /= b;
+			assert(res < BASE);
+			if (result_len == 0 && res > 0) result_len = i + 1;
+			if (i < result.capacity) result.digits[i] = res;
+			else assert(res == 0);
+			if (i == 0) break;
+		}
+		*remaind = carry;
+		return result_len;
+	}
+	
+	// T must fit b * BASE
+	template<typename T>
+	static constexpr operation_type mod_scalar_static(const BigNumView<BASE> a, const operation_type b) {
+		T carry = 0;
+		for (len_type i=a.len; i>0; --i) {
+			carry = ((T)a.digits[i-1] + carry * BASE) % b;
+		}
+		return carry;
+	}
+	
+public:
+	// b may be > BASE
+	// may be result.digits == a.digits
+	// result may be shorter than a if quotient fits in it
+	// returns: result length
+	static constexpr len_type div_static(
+		const BigNumSpan<BASE> result, const BigNumView<BASE> a,
+		const operation_type b, operation_type *remaind
+	) {
+		assert(b > 0);
+		if (b < BASE) {
+			digit_type digit_remaind;
+			len_type result_len = div_static(result, a, b, &digit_remaind);
+			*remaind = digit_remaind;
+			return result_len;
+		}
+		if (a.len == 0) {
+			*remaind = 0;
+			return 0;
+		}
+		if (b <= OPERATION_TYPE_MAX / BASE) {
+			return div_scalar_static<operation_type>(result, a, b, remaind);
+		}
+	#ifdef HAVE_WIDE_OPERATION_TYPE
+		return div_scalar_static<wide_operation_type>(result, a, b, remaind);
+	#else
+		BigNum quotient, big_remaind;
+		quotient.len = div_static(quotient.span(), a, BigNum(b), &big_remaind);
+		assert(quotient.len <= result.capacity);
+		std::copy(quotient.digits, quotient.digits+quotient.len, result.digits);
+		*remaind = big_remaind.value();
+		return quotient.len;
+	#endif
+	}
+	
+	// a mod b, b may be > BASE
+	static constexpr operation_type mod_static(const BigNumView<BASE> a, const operation_type b) {
+		assert(b > 0);
+		if (b <= OPERATION_TYPE_MAX / BASE) {
+			return mod_scalar_static<operation_type>(a, b);
+		}
+	#ifdef HAVE_WIDE_OPERATION_TYPE
+		return mod_scalar_static<wide_operation_type>(a, b);
+	#else
+		BigNum quotient, big_remaind;
+		div_static(quotient, BigNum(a), BigNum(b), &big_remaind);
+		return big_remaind.value();
+	#endif
+	}
+	
+	// b may be > BASE
+	constexpr BigNum div(const operation_type b, operation_type *remaind) const {
+		BigNum result;
+		result.len = div_static(result.span(), *this, b, remaind);
+		return result;
+	}
+	
+	// b may be > BASE
+	constexpr BigNum operator/(const operation_type b) const {
+		operation_type remaind;
 		return div(b, &remaind);
 	}
 	
-	BigNum& operator/=(const digit_type b) {
-		digit_type remaind;
-		div_static(*this, *this, b, &remaind);
+	// b may be > BASE
+	constexpr BigNum& operator/=(const operation_type b) {
+		operation_type remaind;
+		len = div_static(span(), *this, b, &remaind);
+		return *this;
+	}
+	
+	// b may be > BASE
+	constexpr operation_type operator%(const operation_type b) const {
+		return mod_static(*this, b);
+	}
+	
+	// b may be > BASE
+	constexpr BigNum& operator %=(const operation_type b) {
+		(*this) = mod_static(*this, b);
 		return *this;
 	}
 	
 	// may be result === a
-	static void div2_static(BigNum &result, const BigNum &a) {
+	static constexpr void div2_static(BigNum &result, const BigNum &a) {
 		if (!(BASE & (BASE-1))) { // BASE is power of 2
 			if (a.len == 0) {result.len = 0; return;}
 			digit_type carry = 0;
@@ -568,106 +1290,249 @@ public:
 		}
 	}
 	
-	BigNum div2() const {
+	constexpr BigNum div2() const {
 		BigNum result;
 		div2_static(result, *this);
 		return result;
 	}
 	
-	void div2_assign() {
+	constexpr void div2_assign() {
 		div2_static(*this, *this);
 	}
 	
 	static_assert(BASE % 2 == 0, "BASE is not even");
 	
-	bool is_even() const {
+	constexpr bool is_even() const {
 		return (len == 0 || !(digits[0] & 1));
 	}
 	
-	bool is_odd() const {
+	constexpr bool is_odd() const {
 		return (len != 0 && (digits[0] & 1));
 	}
 	
 private:
 	// find max x: b * x <= cur_value
-	static digit_type div_find_digit(const BigNum &b, const BigNum &cur_value) {
+	// product is a scratch for b * x
+	static constexpr digit_type div_find_digit(const BigNumView<BASE> b, const BigNum &cur_value, BigNum &product) {
 		operation_type x = 0;
-		operation_type l = 0, r = BASE, m;
+		operation_type l = 0, r = BASE - 1, m;
 		while (l <= r) {
 			m = (l + r) >> 1;
-			if (b * m <= cur_value) {
+			product.len = add_mul_static(product.span(), 0, b, 0, m);
+			if (product <= cur_value) {
 				x = m;
 				l = m + 1;
 			} else {
 				r = m - 1;
 			}
 		}
-		assert(b * x <= cur_value);
 		return x;
 	}
 	
 public:
-	// may be result === a
-	static void div_static(BigNum &result, const BigNum &a, const BigNum &b, BigNum *remaind) {
+	// may be result.digits == a.digits
+	// result may be shorter than a if quotient fits in it
+	// quotient is not stored if result.digits == NULL and result.capacity == 0
+	// returns: result length
+	static constexpr len_type div_static(
+		const BigNumSpan<BASE> result, const BigNumView<BASE> a,
+		const BigNumView<BASE> b, BigNum *remaind
+	) {
 		assert(b.len > 0);
 		assert(b.len < MAX_LEN);
 		if (a.len == 0) {
 			remaind->len = 0;
-			result.len = 0;
-			return;
+			return 0;
 		}
-		BigNum cur_value(0);
+		BigNum cur_value(0), product;
 		operation_type x;
 		len_type j = 0;
 		for (len_type i = a.len-1;; i--) {
 			cur_value.digits[0] = a.digits[i];
 			if (cur_value.len == 0 && cur_value.digits[0] > 0) cur_value.len = 1;
-			x = div_find_digit(b, cur_value);
-			cur_value -= b * x;
+			x = div_find_digit(b, cur_value, product);
+			product.len = add_mul_static(product.span(), 0, b, 0, x);
+			cur_value -= product;
 			if (j == 0 && x > 0) j = i + 1;
-			result.digits[i] = x;
+			if (i < result.capacity) result.digits[i] = x;
+			else assert(result.digits == NULL || x == 0);
 			if (i == 0) break;
 			cur_value.shift_left_assign(1);
 		}
-		result.len = j;
 		*remaind = cur_value;
+		return j;
 	}
-
-	BigNum div(const BigNum &b, BigNum *remaind) const {
+	
+	// may be result === a
+	static constexpr void div_static(BigNum &result, const BigNum &a, const BigNum &b, BigNum *remaind) {
+		result.len = div_static(result.span(), a, b, remaind);
+	}
+	constexpr BigNum div(const BigNum &b, BigNum *remaind) const {
 		BigNum result;
 		div_static(result, *this, b, remaind);
 		return result;
 	}
 	
-	BigNum operator/(const BigNum &b) const {
+	constexpr BigNum operator/(const BigNum &b) const {
 		BigNum remaind;
 		return div(b, &remaind);
 	}
 	
-	BigNum& operator /=(const BigNum &b) {
+	constexpr BigNum& operator /=(const BigNum &b) {
 		BigNum remaind;
 		div_static(*this, *this, b, &remaind);
 		return *this;
 	}
 	
-	BigNum operator%(const BigNum &b) const {
+	constexpr BigNum operator%(const BigNum &b) const {
 		BigNum remaind;
 		div(b, &remaind);
 		return remaind;
 	}
 	
-	BigNum& operator %=(const BigNum &b) {
+	constexpr BigNum& operator %=(const BigNum &b) {
 		BigNum result = (*this) % b;
 		(*this) = result;
 		return *this;
 	}
 	
+	// division of wider bignum (e.g. result of mul_wide) with quotient in this bignum
+	// quotient may be NULL, else it must fit in this bignum
+	template<len_type L, bool ID, dec_len_type DL, pow_exp_type BDL>
+	static constexpr void divmod(
+		const BigNum<BASE, L, ID, DL, BDL> &a, const BigNum &b,
+		BigNum *quotient, BigNum *remaind
+	) {
+		if (quotient == NULL) {
+			BigNumSpan<BASE> discard = {NULL, 0};
+			div_static(discard, a, b, remaind);
+		} else {
+			quotient->len = div_static(quotient->span(), a, b, remaind);
+		}
+	}
+	
+private:
+	static constexpr operation_type gcd_digit(operation_type a, operation_type b) {
+		while (b != 0) {
+			operation_type r = a % b;
+			a = b;
+			b = r;
+		}
+		return a;
+	}
+	
+	// d^(-1) mod BASE, gcd(d, BASE) = 1
+	static constexpr digit_type inverse_mod_base(const digit_type d) {
+		int_fast64_t r0 = BASE, r1 = d, t0 = 0, t1 = 1, q, tmp;
+		while (r1 != 0) {
+			q = r0 / r1;
+			tmp = r0 - q * r1; r0 = r1; r1 = tmp;
+			tmp = t0 - q * t1; t0 = t1; t1 = tmp;
+		}
+		assert(r0 == 1);
+		if (t0 < 0) t0 += BASE;
+		return t0;
+	}
+	
+	// Hensel division from the low digits, gcd(b.digits[0], BASE) = 1
+	// quotient digit i is a.digits[i] * b.digits[0]^(-1) mod BASE,
+	// digits of a above quotient length are never needed
+	static constexpr len_type divexact_coprime_static(const BigNumSpan<BASE> result, const BigNumView<BASE> a, const BigNumView<BASE> b) {
+		assert(a.len >= b.len);
+		const len_type q_len = a.len - b.len + 1;
+		assert(q_len <= result.capacity);
+		if (result.digits != a.digits) std::copy(a.digits, a.digits+q_len, result.digits);
+		const operation_type inverse = inverse_mod_base(b.digits[0]);
+		operation_type q, borrow, sub, lo;
+		len_type i, j;
+		for (i=0; i<q_len; ++i) {
+			q = (operation_type)result.digits[i] * inverse % BASE;
+			if (q == 0) continue;
+			// result -= q * b * BASE^i, truncated to q_len digits
+			borrow = 0;
+			for (j=0; j<b.len && i+j<q_len; ++j) {
+				sub = (operation_type)b.digits[j] * q + borrow;
+				lo = sub % BASE;
+				borrow = sub / BASE;
+				if ((operation_type)result.digits[i+j] >= lo) {
+					result.digits[i+j] -= lo;
+				} else {
+					result.digits[i+j] += BASE - lo;
+					++borrow;
+				}
+			}
+			for (j+=i; j<q_len && borrow > 0; ++j) {
+				lo = borrow % BASE;
+				borrow /= BASE;
+				if ((operation_type)result.digits[j] >= lo) {
+					result.digits[j] -= lo;
+				} else {
+					result.digits[j] += BASE - lo;
+					++borrow;
+				}
+			}
+			assert(result.digits[i] == 0);
+			result.digits[i] = q;
+		}
+		i = q_len;
+		while (i > 0 && result.digits[i-1] == 0) --i;
+		return i;
+	}
+	
+public:
+	// result = a / b when b divides a (exact division), linear per quotient digit
+	// may be result.digits == a.digits
+	// returns: result length
+	static constexpr len_type divexact_static(const BigNumSpan<BASE> result, BigNumView<BASE> a, BigNumView<BASE> b) {
+		assert(b.len > 0);
+		if (a.len == 0) return 0;
+		// BASE^z divides b and therefore a
+		while (b.digits[0] == 0) {
+			assert(a.digits[0] == 0);
+			++a.digits; --a.len;
+			++b.digits; --b.len;
+		}
+		// g = gcd(b.digits[0], BASE) divides b and therefore a
+		if (gcd_digit(b.digits[0], BASE) > 1) {
+			BigNum a_reduced(a), b_reduced(b);
+			digit_type g, remaind;
+			while ((g = gcd_digit(b_reduced.digits[0], BASE)) > 1) {
+				div_static(a_reduced, a_reduced, g, &remaind);
+				assert(remaind == 0);
+				div_static(b_reduced, b_reduced, g, &remaind);
+				assert(remaind == 0);
+			}
+			return divexact_coprime_static(result, a_reduced, b_reduced);
+		}
+		return divexact_coprime_static(result, a, b);
+	}
+	
 	// may be result === a
-	static void shift_left_static(BigNum &result, const BigNum &a, const len_type exp) {
+	static constexpr void divexact_static(BigNum &result, const BigNum &a, const BigNum &b) {
+		result.len = divexact_static(result.span(), a, b);
+	}
+	
+	// b must divide self
+	constexpr BigNum divexact(const BigNum &b) const {
+		BigNum result;
+		divexact_static(result, *this, b);
+		return result;
+	}
+	
+	// b must divide self
+	constexpr void divexact_assign(const BigNum &b) {
+		divexact_static(*this, *this, b);
+	}
+	
+	// may be result === a
+	static constexpr void shift_left_static(BigNum &result, const BigNum &a, const len_type exp) {
 		assert(a.len <= a.len + exp); // detect overflow
 		assert(a.len + exp <= MAX_LEN);
 		if (a.len == 0) {result.len = 0; return;}
-		if (exp == 0) return;
+		if (exp == 0) {
+			result = a;
+			return;
+		}
 		len_type i;
 		for (i = a.len+exp-1; i>=exp; --i) {
 			result.digits[i] = a.digits[i-exp];
@@ -679,41 +1544,145 @@ public:
 		result.len = a.len + exp;
 	}
 	
-	BigNum shift_left(const len_type exp) const {
+	constexpr BigNum shift_left(const len_type exp) const {
 		BigNum result;
 		shift_left_static(result, *this, exp);
-		return shift_left;
+		return result;
 	}
 	
-	void shift_left_assign(const len_type exp) {
+	constexpr void shift_left_assign(const len_type exp) {
 		shift_left_static(*this, *this, exp);
 	}
 	
 	// on 0^0 returns 1
-	BigNum pow(const len_type exp) const {
+	constexpr BigNum pow(const len_type exp) const {
 		BigNum result(1);
 		len_type mask = LEN_TYPE_MAX_MASK;
 		while (mask != 0 && !(exp & mask)) mask >>= 1;
 		while (mask > 0) {
 			result *= result;
 			if (mask & exp) {
-				result *= (*this);
+				if (len <= 1) result *= (operation_type)(len == 0 ? 0 : digits[0]);
+				else result *= (*this);
 			}
 			mask >>= 1;
 		}
 		return result;
 	}
 	
-	void pow_assign(const len_type exp) {
+	constexpr void pow_assign(const len_type exp) {
 		(*this) = pow(exp);
 	}
 	
-	static BigNum min(const BigNum &a, const BigNum &b) {
+	// pow computed in bounded steps: products are done row by row
+	// by add_mul_static, step(budget) stops after budget digit products;
+	// the task may be dropped or cancelled between steps
+	class PowTask {
+	private:
+		BigNum base, result, product;
+		len_type exp, mask;
+		// current product is result * result, or result * base if multiplying
+		bool multiplying;
+		// next row of current product
+		len_type row;
+		// progress in units of (base.len)^2 digit products:
+		// squaring of base^e costs e*e, multiplying by base costs e
+		operation_type e, units_done, units_total;
+		bool cancelled_;
+		
+		const BigNum& factor() const {
+			return (multiplying ? base : result);
+		}
+		
+		operation_type units() const {
+			return (multiplying ? e : e * e);
+		}
+		
+		// moves to the next product or finishes
+		void next() {
+			if (!multiplying) {
+				e *= 2;
+				if (exp & mask) {
+					multiplying = true;
+					return;
+				}
+			} else {
+				e += 1;
+				multiplying = false;
+			}
+			mask >>= 1;
+		}
+	
+	public:
+		PowTask(const BigNum &b, const len_type exp) :
+			base(b), result(1), exp(exp), mask(LEN_TYPE_MAX_MASK),
+			multiplying(false), row(0), e(0), units_done(0), units_total(0), cancelled_(false)
+		{
+			while (mask != 0 && !(exp & mask)) mask >>= 1;
+			for (len_type m = mask; m > 0; m >>= 1) {
+				units_total += e * e;
+				e *= 2;
+				if (exp & m) units_total += e++;
+			}
+			e = 0;
+		}
+		
+		// returns: whether task needs more steps
+		bool step(const size_t budget) {
+			size_t work = 0;
+			while (!done() && !cancelled_ && work < budget) {
+				const BigNum &b = factor();
+				if (row < b.len) {
+					if (row == 0) product.len = 0;
+					product.len = add_mul_static(product.span(), product.len, result, row, b.digits[row]);
+					work += result.len + 1;
+					++row;
+				}
+				if (row >= b.len) {
+					if (row == 0) product.len = 0;
+					result = product;
+					units_done += units();
+					row = 0;
+					next();
+				}
+			}
+			return !done() && !cancelled_;
+		}
+		
+		bool done() const {
+			return mask == 0;
+		}
+		
+		// remaining steps do nothing, value is never available
+		void cancel() {
+			cancelled_ = true;
+		}
+		
+		bool cancelled() const {
+			return cancelled_;
+		}
+		
+		// estimated fraction of work done, 0..1
+		double progress() const {
+			if (done()) return 1;
+			if (units_total == 0) return 0;
+			const len_type rows = factor().len;
+			const double current = (rows == 0 ? 0 : (double)units() * row / rows);
+			return (units_done + current) / units_total;
+		}
+		
+		const BigNum& value() const {
+			assert(done() && !cancelled_);
+			return result;
+		}
+	};
+	
+	static constexpr BigNum min(const BigNum &a, const BigNum &b) {
 		if (a <= b) return a;
 		return b;
 	}
 	
-	static BigNum max(const BigNum &a, const BigNum &b) {
+	static constexpr BigNum max(const BigNum &a, const BigNum &b) {
 		if (a >= b) return a;
 		return b;
 	}
@@ -729,20 +1698,20 @@ public:
 		if (n.len % 2 == 1) {
 			l.len = r.len = (n.len+1) / 2;
 			assert(l.len > 0);
-			for (len_type i=0; i<l.len-1; ++i) l.digits[i] = r.digits[i] = 0;
+			for (len_type i=0; i+1<l.len; ++i) l.digits[i] = r.digits[i] = 0;
 			
 			l.digits[l.len-1] = floor(sqrt(leading));
 			r.digits[r.len-1] = ceil (sqrt(leading+1));
 		} else {
 			l.len = r.len = n.len / 2;
 			assert(l.len > 0);
-			for (len_type i=0; i<l.len-1; ++i) l.digits[i] = r.digits[i] = 0;
+			for (len_type i=0; i+1<l.len; ++i) l.digits[i] = r.digits[i] = 0;
 			
 			digit_type l_leading = floor(sqrt(leading) * sqrt(BASE));
 			assert(l_leading < BASE);
 			l.digits[l.len-1] = l_leading;
 			
-			digit_type r_leading = (
+			operation_type r_leading = (
 				leading + 1 == BASE ?
 				BASE :
 				ceil(sqrt(leading+1) * sqrt(BASE))
@@ -776,68 +1745,169 @@ public:
 		return l;
 	}
 	
-	// solves a*x - b*y = gcd(a,b)
-	// a, b > 0 and are not both even
-	static void extended_binary_euclidean(
-		const BigNum &a, const BigNum &b,
-		BigNum *x, BigNum *y, BigNum *gcd
-	) {
-		assert(a > 0 && b > 0);
-		assert(!( a.is_even() && b.is_even() ));
-		assert(a.len < MAX_LEN && b.len < MAX_LEN);
-		
-		BigNum r0 = a, r1 = b;
-		BigNum s0 = 1, s1 = b;
-		BigNum t0 = 0, t1 = a - 1;
-		
-		while (r0.is_even()) {
-			r0.div2_assign();
-			if (s0.is_even() && t0.is_even()) {
-				s0.div2_assign();
-				t0.div2_assign();
+private:
+	typedef SignedBigNum<BigNum> Signed;
+	
+	// (s, t) = (s, t) / 2 keeping a*s - b*t, a*s - b*t must be even
+	// if they are not both even (s, t) is moved by (b, a) towards zero first
+	static void halve_cofactors(Signed &s, Signed &t, const BigNum &a, const BigNum &b) {
+		if (!(s.is_even() && t.is_even())) {
+			if (s.is_negative()) {
+				s += b;
+				t += a;
 			} else {
-				s0 += b; assert(s0.is_even()); s0.div2_assign();
-				t0 += a; assert(t0.is_even()); t0.div2_assign();
+				s -= b;
+				t -= a;
 			}
+			assert(s.is_even() && t.is_even());
 		}
+		s.div2_assign();
+		t.div2_assign();
+	}
+	
+	// state of extended_binary_euclidean between iterations,
+	// a and b are passed to each iteration and are not stored
+	struct EuclideanState {
+		enum Phase {HALVE_R0, REDUCE, DONE};
 		
-		while (1) {
-			while (r1.is_even()) {
-				r1.div2_assign();
-				if (s1.is_even() && t1.is_even()) {
-					s1.div2_assign();
-					t1.div2_assign();
+		// a * s - b * t = r
+		BigNum r0, r1;
+		Signed s0, s1, t0, t1;
+		Phase phase;
+		// each halving removes one bit of r0 or r1, subtractions do not add bits
+		size_t halvings;
+		
+		EuclideanState(const BigNum &a, const BigNum &b) :
+			r0(a), r1(b), s0(1), s1(0), t0(0), t1(BigNum(1), true),
+			phase(HALVE_R0), halvings(0)
+		{
+			assert(a > 0 && b > 0);
+			assert(!( a.is_even() && b.is_even() ));
+			assert(a.len < MAX_LEN && b.len < MAX_LEN);
+		}
+		
+		// one halving or subtraction
+		void iterate(const BigNum &a, const BigNum &b) {
+			if (phase == HALVE_R0) {
+				if (r0.is_even()) {
+					r0.div2_assign();
+					halve_cofactors(s0, t0, a, b);
+					++halvings;
 				} else {
-					s1 += b; assert(s1.is_even()); s1.div2_assign();
-					t1 += a; assert(t1.is_even()); t1.div2_assign();
+					phase = REDUCE;
 				}
-			}
-			if (r0 > r1) {
+			} else if (r1.is_even()) {
+				r1.div2_assign();
+				halve_cofactors(s1, t1, a, b);
+				++halvings;
+			} else if (r0 > r1) {
 				swap(r0, r1);
-				swap(s0, s1);
-				swap(t0, t1);
+				Signed::swap(s0, s1);
+				Signed::swap(t0, t1);
 			} else if (r0 == r1) {
-				break;
-			}
-			r1 -= r0;
-			if (s1 >= s0 && t1 >= t0) {
+				// move solution to 0 <= x, 0 <= y, x < b or y < a
+				while (s1.is_negative() || t1.is_negative()) {
+					s1 += b;
+					t1 += a;
+				}
+				while (s1.abs() >= b && t1.abs() >= a) {
+					s1 -= b;
+					t1 -= a;
+				}
+				phase = DONE;
+			} else {
+				r1 -= r0;
 				s1 -= s0;
 				t1 -= t0;
-			} else {
-				assert(s0 <= b);
-				assert(t0 <= a);
-				s1 += b - s0;
-				t1 += a - t0;
 			}
-		};
+		}
 		
-		//assert(a * s1 - b * t1 == r1);
-		assert(s1 < b || t1 < a);
-		*x = s1;
-		*y = t1;
-		*gcd = r1;
+		void result(BigNum *x, BigNum *y, BigNum *gcd) const {
+			assert(phase == DONE);
+			*x = s1.abs();
+			*y = t1.abs();
+			*gcd = r1;
+		}
+	};
+	
+public:
+	// extended_binary_euclidean computed in bounded steps:
+	// step(budget) stops after about budget digit operations,
+	// one iteration (halving or subtraction) costs a.len + b.len;
+	// the task may be dropped or cancelled between steps
+	class ExtendedBinaryEuclideanTask {
+	private:
+		// copies, arguments of task need not outlive it
+		BigNum a, b;
+		EuclideanState state;
+		size_t max_halvings;
+		bool cancelled_;
+		
+		// upper bound of bit length
+		static size_t bits(const BigNum &n) {
+			constexpr size_t digit_bits = log_floor_constexpr(2, BASE-1) + 1;
+			size_t result = (size_t)(n.len - 1) * digit_bits;
+			for (operation_type top = n.digits[n.len-1]; top > 0; top >>= 1) ++result;
+			return result;
+		}
+		
+	public:
+		// a, b > 0 and are not both even
+		ExtendedBinaryEuclideanTask(const BigNum &a, const BigNum &b) :
+			a(a), b(b), state(a, b), max_halvings(bits(a) + bits(b)), cancelled_(false) {}
+		
+		// returns: whether task needs more steps
+		bool step(const size_t budget) {
+			const size_t cost = a.len + b.len;
+			for (size_t work = 0; !done() && !cancelled_ && work < budget; work += cost) {
+				state.iterate(a, b);
+			}
+			return !done() && !cancelled_;
+		}
+		
+		bool done() const {
+			return state.phase == EuclideanState::DONE;
+		}
+		
+		// remaining steps do nothing, result is never available
+		void cancel() {
+			cancelled_ = true;
+		}
+		
+		bool cancelled() const {
+			return cancelled_;
+		}
+		
+		// estimated fraction of work done, 0..1
+		double progress() const {
+			if (done()) return 1;
+			return (double)state.halvings / max_halvings;
+		}
+		
+		// a*x - b*y = gcd
+		void result(BigNum *x, BigNum *y, BigNum *gcd) const {
+			assert(!cancelled_);
+			state.result(x, y, gcd);
+		}
+	};
+	
+	// solves a*x - b*y = gcd(a,b)
+	// a, b > 0 and are not both even
+	static void extended_binary_euclidean(
+		const BigNum &a, const BigNum &b,
+		BigNum *x, BigNum *y, BigNum *gcd
+	) {
+		EuclideanState state(a, b);
+		while (state.phase != EuclideanState::DONE) state.iterate(a, b);
+		state.result(x, y, gcd);
 	}
 	
+	// temporaries of linear_diophantine, may be reused between calls
+	struct LinearDiophantineScratch {
+		BigNum xe, ye, gcd, ar, br, cr, crem, yr;
+		BigNum<BASE, MAX_LEN + MAX_LEN> wide;
+	};
+	
 	// solves a*x - b*y = c
 	// a, b > 0 and are not both even
 	// returns: success
@@ -845,32 +1915,792 @@ public:
 		const BigNum &a, const BigNum &b, const BigNum &c,
 		BigNum *x, BigNum *y
 	) {
-		BigNum xe, ye, gcd;
-		extended_binary_euclidean(a, b, &xe, &ye, &gcd);
+		LinearDiophantineScratch scratch;
+		return linear_diophantine(a, b, c, x, y, scratch);
+	}
+	
+	static bool linear_diophantine(
+		const BigNum &a, const BigNum &b, const BigNum &c,
+		BigNum *x, BigNum *y, LinearDiophantineScratch &s
+	) {
+		extended_binary_euclidean(a, b, &s.xe, &s.ye, &s.gcd);
 		// a * xe - b * ye = gcd
-		BigNum ar, br, cr, crem;
-		cr = c.div(gcd, &crem);
-		if (crem != 0) return false;
-		ar = a / gcd;
-		br = b / gcd;
+		s.cr = c.div(s.gcd, &s.crem);
+		if (s.crem != 0) return false;
+		s.ar = a.divexact(s.gcd);
+		s.br = b.divexact(s.gcd);
 		// ar * xe - br * ye = 1    | * cr
+		// ar * (xe * cr) - br * (ye * cr) = cr
+		// smallest solution: y = ye * cr mod ar, x = (br * y + cr) / ar
 		
-		typedef BigNum<BASE, MAX_LEN*2> DoubleBigNum;
-		DoubleBigNum ad = ar, bd = br, cd = cr;
-		DoubleBigNum xd = xe, yd = ye;
-		xd *= cd;
-		yd *= cd;
-		// ad * xd - bd * yd = cd
-		DoubleBigNum pd = DoubleBigNum::min(xd / bd, yd / ad);
-		xd -= bd * pd;
-		yd -= ad * pd;
-		
-		BigNum xr = xd;
-		BigNum yr = yd;
-		*x = xr;
-		*y = yr;
+		s.wide = s.ye.mul_wide(s.cr);
+		divmod(s.wide, s.ar, NULL, &s.yr);
+		s.wide = s.br.mul_wide(s.yr);
+		s.wide += s.cr;
+		s.wide.divexact_assign(s.ar);
+		
+		*x = s.wide;
+		*y = s.yr;
 		return true;
 	}
+	
+private:
+	// odd primes < 1024 grouped so that a group product is a scalar divisor of operation_type path
+	struct SmallPrimes {
+		static constexpr operation_type LIMIT = 1024;
+		operation_type primes[LIMIT / 2];
+		len_type count;
+		operation_type products[LIMIT / 2];
+		// primes of group i are [ends[i-1], ends[i])
+		len_type ends[LIMIT / 2];
+		len_type group_count;
+		
+		SmallPrimes() : count(0), group_count(0) {
+			bool composite[LIMIT] = {};
+			for (operation_type p=3; p<LIMIT; p+=2) {
+				if (composite[p]) continue;
+				for (operation_type q=p*p; q<LIMIT; q+=2*p) composite[q] = true;
+				if (group_count == 0 || products[group_count-1] > OPERATION_TYPE_MAX / BASE / p) {
+					products[group_count++] = 1;
+				}
+				products[group_count-1] *= p;
+				primes[count++] = p;
+				ends[group_count-1] = count;
+			}
+		}
+	};
+	
+	// computed once per BASE
+	static const SmallPrimes& small_primes() {
+		static const SmallPrimes primes;
+		return primes;
+	}
+	
+	// exponent for modular exponentiation, bits are read from digits
+	typedef BigNum<0x100000000llu, (MAX_LEN * (log_floor_constexpr(2, BASE-1) + 1) + 31) / 32 + 1> Binary;
+	
+	static size_t bit_length(const Binary &e) {
+		const BigNumView<0x100000000llu> v = e.view();
+		if (v.len == 0) return 0;
+		size_t bits = (size_t)(v.len - 1) * 32;
+		for (operation_type top = v.digits[v.len-1]; top > 0; top >>= 1) ++bits;
+		return bits;
+	}
+	
+	static unsigned int bit(const Binary &e, const size_t i) {
+		const BigNumView<0x100000000llu> v = e.view();
+		if (i / 32 >= v.len) return 0;
+		return (v.digits[i / 32] >> (i % 32)) & 1;
+	}
+	
+	// lowest set bit, e > 0
+	static size_t trailing_zeros(const Binary &e) {
+		size_t i = 0;
+		while (bit(e, i) == 0) ++i;
+		return i;
+	}
+	
+	// residues modulo odd m in Montgomery form x*R mod m, R = BASE^m.len,
+	// or in plain form with product reduced by division if gcd(m, BASE) > 1
+	struct Modular {
+		BigNum m;
+		bool redc;
+		// -m^(-1) mod BASE
+		operation_type m_inv;
+		// 1 and m-1 in residue form
+		BigNum one, minus_one;
+		// R^2 mod m
+		BigNum r2;
+		
+		explicit Modular(const BigNum &modulus) :
+			m(modulus), redc(gcd_digit(modulus.digits[0], BASE) == 1), m_inv(0)
+		{
+			assert(m.len > 0 && m.len < MAX_LEN);
+			if (redc) {
+				m_inv = BASE - inverse_mod_base(m.digits[0]);
+				BigNum<BASE, MAX_LEN + 1> r;
+				r.len = m.len + 1;
+				for (len_type i=0; i<m.len; ++i) r.digits[i] = 0;
+				r.digits[m.len] = 1;
+				divmod(r, m, NULL, &one);
+				divmod(one.mul_wide(one), m, NULL, &r2);
+			} else {
+				one = 1;
+			}
+			minus_one = m - one;
+		}
+		
+		// a * b * R^(-1) mod m, a, b < m
+		BigNum mul(const BigNum &a, const BigNum &b) const {
+			BigNum result;
+			if (!redc) {
+				divmod(a.mul_wide(b), m, NULL, &result);
+				return result;
+			}
+			// t = a * b, then for i < m.len: t += (t.digits[i] * m_inv mod BASE) * m * BASE^i zeroes digit i
+			digit_type t_digits[MAX_LEN * 2 + 1];
+			const BigNumSpan<BASE> t = {t_digits, MAX_LEN * 2 + 1};
+			len_type t_len = mul_static(t, a, b);
+			for (len_type i=0; i<m.len; ++i) {
+				if (i >= t_len) break;
+				const operation_type u = t_digits[i] * m_inv % BASE;
+				t_len = add_mul_static(t, t_len, m, i, u);
+			}
+			// t / R < 2m
+			const len_type result_len = (t_len > m.len ? t_len - m.len : 0);
+			assert(result_len <= MAX_LEN);
+			result.len = result_len;
+			std::copy(t_digits + m.len, t_digits + m.len + result_len, result.digits);
+			if (result >= m) result -= m;
+			return result;
+		}
+		
+		BigNum to(const BigNum &a) const {
+			if (!redc) return a;
+			return mul(a, r2);
+		}
+		
+		BigNum add(const BigNum &a, const BigNum &b) const {
+			BigNum result = a + b;
+			if (result >= m) result -= m;
+			return result;
+		}
+		
+		BigNum sub(const BigNum &a, const BigNum &b) const {
+			if (a >= b) return a - b;
+			return (a + m) - b;
+		}
+		
+		// a / 2 mod m
+		BigNum half(const BigNum &a) const {
+			BigNum result = a;
+			if (result.is_odd()) result += m;
+			result.div2_assign();
+			return result;
+		}
+		
+		// a^(e >> lo), fixed window of 4 bits
+		BigNum pow(const BigNum &a, const Binary &e, const size_t lo) const {
+			BigNum table[16];
+			table[0] = one;
+			for (unsigned int k=1; k<16; ++k) table[k] = mul(table[k-1], a);
+			BigNum result = one;
+			for (size_t i=bit_length(e); i>lo;) {
+				const unsigned int w = std::min<size_t>(4, i - lo);
+				unsigned int index = 0;
+				for (unsigned int k=0; k<w; ++k) {
+					result = mul(result, result);
+					index = (index << 1) | bit(e, i - 1 - k);
+				}
+				if (index > 0) result = mul(result, table[index]);
+				i -= w;
+			}
+			return result;
+		}
+	};
+	
+	// strong probable prime to base a, n - 1 = d * 2^s, d = n_minus_1 >> s
+	static bool miller_rabin(const Modular &mod, const Binary &n_minus_1, const size_t s, const operation_type a) {
+		BigNum x = mod.pow(mod.to(a), n_minus_1, s);
+		if (x == mod.one || x == mod.minus_one) return true;
+		for (size_t r=1; r<s; ++r) {
+			x = mod.mul(x, x);
+			if (x == mod.minus_one) return true;
+			if (x == mod.one) return false;
+		}
+		return false;
+	}
+	
+	// Jacobi symbol (a/n), n odd
+	static int jacobi_digit(operation_type a, operation_type n) {
+		int result = 1;
+		a %= n;
+		while (a != 0) {
+			while (a % 2 == 0) {
+				a /= 2;
+				if (n % 8 == 3 || n % 8 == 5) result = -result;
+			}
+			std::swap(a, n);
+			if (a % 4 == 3 && n % 4 == 3) result = -result;
+			a %= n;
+		}
+		return (n == 1 ? result : 0);
+	}
+	
+	// Jacobi symbol (d/n), n odd, |d| odd
+	static int jacobi(const int_fast64_t d, const BigNum &n) {
+		const operation_type d_abs = (d < 0 ? -d : d);
+		const operation_type n_mod_4 = mod_static(n, 4);
+		int result = 1;
+		// (-1/n) = (-1)^((n-1)/2)
+		if (d < 0 && n_mod_4 == 3) result = -result;
+		// quadratic reciprocity
+		if (d_abs % 4 == 3 && n_mod_4 == 3) result = -result;
+		return result * jacobi_digit(mod_static(n, d_abs), d_abs);
+	}
+	
+	// x in residue form
+	static BigNum signed_residue(const Modular &mod, const int_fast64_t x) {
+		const BigNum r = mod.to(BigNum((operation_type)(x < 0 ? -x : x)));
+		if (x < 0 && r != 0) return mod.m - r;
+		return r;
+	}
+	
+	// strong Lucas probable prime with Selfridge parameters P = 1, Q = (1 - D) / 4
+	// n is odd, has no factor among small primes
+	static bool strong_lucas(const Modular &mod, const BigNum &n) {
+		int_fast64_t d = 5;
+		for (unsigned int i=0;; ++i) {
+			const int j = jacobi(d, n);
+			if (j == -1) break;
+			// n > |d| has factor |d|
+			if (j == 0) return false;
+			// no such D for squares
+			if (i == 16) {
+				const BigNum root = square_root(n);
+				if (root * root == n) return false;
+			}
+			d = (d < 0 ? -d + 2 : -d - 2);
+		}
+		const BigNum dm = signed_residue(mod, d);
+		const BigNum q = signed_residue(mod, (1 - d) / 4);
+		// n + 1 = k * 2^s
+		const Binary n_plus_1(n + 1);
+		const size_t s = trailing_zeros(n_plus_1);
+		// U_k, V_k, Q^k
+		BigNum u = mod.one, v = mod.one, qk = q;
+		for (size_t i=bit_length(n_plus_1)-1; i>s; --i) {
+			// k -> 2k
+			u = mod.mul(u, v);
+			v = mod.sub(mod.mul(v, v), mod.add(qk, qk));
+			qk = mod.mul(qk, qk);
+			if (bit(n_plus_1, i - 1)) {
+				// k -> k+1
+				const BigNum u_next = mod.half(mod.add(u, v));
+				v = mod.half(mod.add(mod.mul(dm, u), v));
+				u = u_next;
+				qk = mod.mul(qk, q);
+			}
+		}
+		if (u == 0 || v == 0) return true;
+		for (size_t r=1; r<s; ++r) {
+			v = mod.sub(mod.mul(v, v), mod.add(qk, qk));
+			if (v == 0) return true;
+			qk = mod.mul(qk, qk);
+		}
+		return false;
+	}
+	
+public:
+	// returns: false if composite, true if prime or probable prime
+	// trial division by primes < 1024, then for n < 2^64 deterministic Miller-Rabin (exact result),
+	// else Baillie-PSW (Miller-Rabin to base 2 and strong Lucas) if lucas,
+	// else Miller-Rabin to the first 12 prime bases
+	bool is_probable_prime(const bool lucas = true) const {
+		assert(len < MAX_LEN);
+		if (*this < 2) return false;
+		if (is_even()) return *this < 3;
+		const SmallPrimes &small = small_primes();
+		for (len_type g=0; g<small.group_count; ++g) {
+			const operation_type r = mod_static(*this, small.products[g]);
+			for (len_type i=(g == 0 ? 0 : small.ends[g-1]); i<small.ends[g]; ++i) {
+				if (r % small.primes[i] == 0) return *this < small.primes[i] + 1;
+			}
+		}
+		if (*this < SmallPrimes::LIMIT * SmallPrimes::LIMIT) return true;
+		if (*this <= UINT32_MAX) return bignum_is_prime_digit(value());
+		
+		const Modular mod(*this);
+		const Binary n_minus_1(*this - 1);
+		const size_t s = trailing_zeros(n_minus_1);
+		static const operation_type bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+		// deterministic below 3.18 * 10^23
+		const bool small_n = *this < OPERATION_TYPE_MAX;
+		if (small_n || !lucas) {
+			for (operation_type a : bases) {
+				if (!miller_rabin(mod, n_minus_1, s, a)) return false;
+			}
+			return true;
+		}
+		if (!miller_rabin(mod, n_minus_1, s, 2)) return false;
+		return strong_lucas(mod, *this);
+	}
+	
+	// inverse = a^(-1) mod m, m > 0
+	// returns: success (gcd(a, m) = 1)
+	static bool inverse_mod(const BigNum &a, const BigNum &m, BigNum *inverse) {
+		assert(m != 0);
+		if (m == 1) {
+			*inverse = 0;
+			return true;
+		}
+		const BigNum ar = a % m;
+		if (ar == 0 || (ar.is_even() && m.is_even())) return false;
+		BigNum x, y, gcd;
+		extended_binary_euclidean(ar, m, &x, &y, &gcd);
+		if (gcd != 1) return false;
+		// ar * x - m * y = 1
+		*inverse = (x < m ? x : x % m);
+		return true;
+	}
+	
+	// inverses[i] = values[i]^(-1) mod m by Montgomery's trick:
+	// one inverse_mod of product of values and 3*(count-1) modular multiplications
+	// m length < MAX_LEN, inverses must not overlap values
+	// returns: success (all values are invertible), else inverses are undefined
+	static bool batch_inverse(const BigNum *values, const size_t count, const BigNum &m, BigNum *inverses) {
+		if (count == 0) return true;
+		const Modular mod(m);
+		// with Montgomery multiplication q[i] = values[0] * ... * values[i] * R^(-i)
+		inverses[0] = (values[0] < m ? values[0] : values[0] % m);
+		for (size_t i=1; i<count; ++i) {
+			inverses[i] = mod.mul(inverses[i-1], (values[i] < m ? values[i] : values[i] % m));
+		}
+		// t = (values[0] * ... * values[i])^(-1) * R^i
+		BigNum t;
+		if (!inverse_mod(inverses[count-1], m, &t)) return false;
+		for (size_t i=count-1; i>0; --i) {
+			inverses[i] = mod.mul(t, inverses[i-1]);
+			t = mod.mul(t, (values[i] < m ? values[i] : values[i] % m));
+		}
+		inverses[0] = t;
+		return true;
+	}
+	
+	// x = residues[i] mod moduli[i] for all i, 0 <= x < product of moduli
+	// product tree of moduli P, remainder tree of c_v = (M / P_v) mod P_v from c_root = 1:
+	// c_left = (c_v mod P_left) * (P_right mod P_left) mod P_left,
+	// then x_leaf = residue * c_leaf^(-1) mod modulus and x_v = x_left * P_right + x_right * P_left mod P_v
+	// moduli > 0, length of product of moduli < MAX_LEN
+	// returns: success (moduli are pairwise coprime)
+	static bool crt_combine(const BigNum *residues, const BigNum *moduli, const size_t count, BigNum *x) {
+		if (count == 0) {
+			*x = 0;
+			return true;
+		}
+		// tree[0] are leaves, node i of level k has children 2i and 2i+1 (if exists) of level k-1
+		std::vector< std::vector<BigNum> > tree(1, std::vector<BigNum>(moduli, moduli + count));
+		while (tree.back().size() > 1) {
+			const std::vector<BigNum> &children = tree.back();
+			std::vector<BigNum> level((children.size() + 1) / 2);
+			for (size_t i=0; i<level.size(); ++i) {
+				level[i] = (2*i+1 < children.size() ? children[2*i] * children[2*i+1] : children[2*i]);
+			}
+			tree.push_back(level);
+		}
+		
+		// top-down: c_v
+		std::vector<BigNum> c(1, BigNum(1) % tree.back()[0]), child_c;
+		for (size_t k=tree.size()-1; k>0; --k) {
+			const std::vector<BigNum> &children = tree[k-1];
+			child_c.resize(children.size());
+			for (size_t i=0; i<c.size(); ++i) {
+				if (2*i+1 >= children.size()) {
+					child_c[2*i] = c[i];
+					continue;
+				}
+				const BigNum &left = children[2*i], &right = children[2*i+1];
+				divmod((c[i] % left).mul_wide(right % left), left, NULL, &child_c[2*i]);
+				divmod((c[i] % right).mul_wide(left % right), right, NULL, &child_c[2*i+1]);
+			}
+			c.swap(child_c);
+		}
+		
+		// bottom-up: x_v
+		std::vector<BigNum> xs(count), parent_xs;
+		for (size_t i=0; i<count; ++i) {
+			BigNum inverse;
+			if (!inverse_mod(c[i], moduli[i], &inverse)) return false;
+			divmod((residues[i] % moduli[i]).mul_wide(inverse), moduli[i], NULL, &xs[i]);
+		}
+		for (size_t k=1; k<tree.size(); ++k) {
+			const std::vector<BigNum> &children = tree[k-1];
+			parent_xs.resize(tree[k].size());
+			for (size_t i=0; i<parent_xs.size(); ++i) {
+				if (2*i+1 >= children.size()) {
+					parent_xs[i] = xs[2*i];
+					continue;
+				}
+				BigNum &sum = parent_xs[i];
+				sum = xs[2*i] * children[2*i+1];
+				sum += xs[2*i+1] * children[2*i];
+				if (sum >= tree[k][i]) sum -= tree[k][i];
+			}
+			xs.swap(parent_xs);
+		}
+		*x = xs[0];
+		return true;
+	}
+};
+
+// sign-magnitude wrapper over unsigned BigNum, zero is never negative
+template<class UnsignedBigNum>
+class SignedBigNum {
+private:
+	UnsignedBigNum magnitude;
+	bool negative;
+	
+	// self += (-1)^b_negative * b
+	void add_signed(const UnsignedBigNum &b, const bool b_negative) {
+		if (negative == b_negative) {
+			UnsignedBigNum::add_static(magnitude, magnitude, b);
+		} else if (magnitude >= b) {
+			UnsignedBigNum::sub_static(magnitude, magnitude, b);
+		} else {
+			UnsignedBigNum::sub_static(magnitude, b, magnitude);
+			negative = b_negative;
+		}
+		if (magnitude == 0) negative = false;
+	}
+	
+public:
+	SignedBigNum() : magnitude(), negative(false) {}
+	
+	SignedBigNum(operation_type n) : magnitude(n), negative(false) {}
+	
+	SignedBigNum(const UnsignedBigNum &b, const bool b_negative = false) :
+		magnitude(b), negative(b_negative && b != 0) {}
+	
+	const UnsignedBigNum& abs() const {
+		return magnitude;
+	}
+	
+	bool is_negative() const {
+		return negative;
+	}
+	
+	static void swap(SignedBigNum &a, SignedBigNum &b) {
+		UnsignedBigNum::swap(a.magnitude, b.magnitude);
+		std::swap(a.negative, b.negative);
+	}
+	
+	// print decimal
+	void fprintd(FILE *stream) const {
+		if (negative) fputc('-', stream);
+		magnitude.fprintd(stream);
+	}
+	
+	// print decimal
+	void printd() const {
+		fprintd(stdout);
+	}
+	
+	// returns: <0, 0 or >0 like strcmp
+	static int compare(const SignedBigNum &a, const SignedBigNum &b) {
+		if (a.negative != b.negative) return (a.negative ? -1 : 1);
+		int res = BigNumView<UnsignedBigNum::base>::compare(a.magnitude, b.magnitude);
+		return (a.negative ? -res : res);
+	}
+	
+	bool operator <(const SignedBigNum &b) const {
+		return compare(*this, b) < 0;
+	}
+	
+	bool operator <=(const SignedBigNum &b) const {
+		return compare(*this, b) <= 0;
+	}
+	
+	bool operator >(const SignedBigNum &b) const {
+		return compare(*this, b) > 0;
+	}
+	
+	bool operator >=(const SignedBigNum &b) const {
+		return compare(*this, b) >= 0;
+	}
+	
+	bool operator ==(const SignedBigNum &b) const {
+		return compare(*this, b) == 0;
+	}
+	
+	bool operator !=(const SignedBigNum &b) const {
+		return compare(*this, b) != 0;
+	}
+	
+	SignedBigNum operator-() const {
+		return SignedBigNum(magnitude, !negative);
+	}
+	
+	SignedBigNum& operator +=(const SignedBigNum &b) {
+		add_signed(b.magnitude, b.negative);
+		return *this;
+	}
+	
+	SignedBigNum& operator +=(const UnsignedBigNum &b) {
+		add_signed(b, false);
+		return *this;
+	}
+	
+	SignedBigNum& operator -=(const SignedBigNum &b) {
+		add_signed(b.magnitude, !b.negative);
+		return *this;
+	}
+	
+	SignedBigNum& operator -=(const UnsignedBigNum &b) {
+		add_signed(b, true);
+		return *this;
+	}
+	
+	SignedBigNum operator+(const SignedBigNum &b) const {
+		SignedBigNum result(*this);
+		result += b;
+		return result;
+	}
+	
+	SignedBigNum operator-(const SignedBigNum &b) const {
+		SignedBigNum result(*this);
+		result -= b;
+		return result;
+	}
+	
+	SignedBigNum operator*(const SignedBigNum &b) const {
+		return SignedBigNum(magnitude * b.magnitude, negative != b.negative);
+	}
+	
+	SignedBigNum& operator *=(const SignedBigNum &b) {
+		magnitude *= b.magnitude;
+		negative = (negative != b.negative) && magnitude != 0;
+		return *this;
+	}
+	
+	// rounds towards zero
+	void div2_assign() {
+		magnitude.div2_assign();
+		if (magnitude == 0) negative = false;
+	}
+	
+	bool is_even() const {
+		return magnitude.is_even();
+	}
+	
+	bool is_odd() const {
+		return magnitude.is_odd();
+	}
+};
+
+// sum of many bignumbers and products with deferred carries:
+// each digit is kept in column of operation_type,
+// carries are propagated when column headroom is exhausted or value is read
+template<class UnsignedBigNum>
+class BigNumAccumulator {
+private:
+	static constexpr operation_type BASE = UnsignedBigNum::base;
+	static constexpr len_type MAX_LEN = UnsignedBigNum::max_len;
+	// count of additions of digit (< BASE) which fit in column
+	static constexpr operation_type CAPACITY = OPERATION_TYPE_MAX / (BASE-1);
+	
+	// one spare column for product of length MAX_LEN+1 with leading zero
+	operation_type columns[MAX_LEN + 1];
+	len_type len;
+	// count of digit additions since columns were < BASE
+	operation_type pending;
+	
+	void reserve(const operation_type additions) {
+		assert(additions < CAPACITY);
+		if (pending + additions > CAPACITY) normalize();
+		pending += additions;
+	}
+	
+	void extend(const len_type new_len) {
+		assert(new_len <= MAX_LEN + 1);
+		for (; len<new_len; ++len) columns[len] = 0;
+	}
+	
+	// columns < BASE
+	void normalize() {
+		operation_type carry = 0;
+		for (len_type i=0; i<len; ++i) {
+			const operation_type low = columns[i] % BASE + carry;
+			carry = columns[i] / BASE + low / BASE;
+			columns[i] = low % BASE;
+		}
+		for (; carry > 0; carry /= BASE) {
+			assert(len <= MAX_LEN);
+			columns[len++] = carry % BASE;
+		}
+		pending = 1;
+	}
+	
+public:
+	BigNumAccumulator() : len(0), pending(0) {}
+	
+	void clear() {
+		len = 0;
+		pending = 0;
+	}
+	
+	BigNumAccumulator& operator +=(const BigNumView<BASE> &b) {
+		reserve(1);
+		extend(b.len);
+		for (len_type i=0; i<b.len; ++i) columns[i] += b.digits[i];
+		return *this;
+	}
+	
+	// self += a * b without computing product:
+	// each partial product is split into two digits added to adjacent columns
+	void add_mul(const BigNumView<BASE> &a, const BigNumView<BASE> &b) {
+		if (a.len == 0 || b.len == 0) return;
+		reserve(2 * (operation_type)std::min(a.len, b.len));
+		extend(a.len + b.len);
+		for (len_type i=0; i<a.len; ++i) {
+			const operation_type ai = a.digits[i];
+			operation_type *c = columns + i;
+			for (len_type j=0; j<b.len; ++j) {
+				const operation_type p = ai * b.digits[j];
+				c[j] += p % BASE;
+				c[j+1] += p / BASE;
+			}
+		}
+	}
+	
+	// normalizes and returns sum, sum must fit in UnsignedBigNum
+	UnsignedBigNum value() {
+		normalize();
+		while (len > 0 && columns[len-1] == 0) --len;
+		assert(len <= MAX_LEN);
+		typename UnsignedBigNum::digit_type digits[MAX_LEN];
+		for (len_type i=0; i<len; ++i) digits[i] = columns[i];
+		const BigNumView<BASE> v = {digits, len};
+		return UnsignedBigNum(v);
+	}
+};
+
+// residue number system: bignumber as residues modulo COUNT largest primes < 2^31
+// add, sub and mul are elementwise, value is reconstructed by Garner's algorithm
+// values are modulo product of primes, by default it is >= BASE^MAX_LEN
+template<
+	class UnsignedBigNum,
+	len_type COUNT = (UnsignedBigNum::max_len * (log_floor_constexpr(2, UnsignedBigNum::base - 1) + 1) + 29) / 30
+>
+class BigNumRNS {
+private:
+	static_assert(COUNT > 0, "COUNT is zero");
+	static constexpr operation_type BASE = UnsignedBigNum::base;
+	
+	struct Moduli {
+		// descending
+		digit_type p[COUNT];
+		// inv[i*(i-1)/2 + j] = p[j]^-1 mod p[i], j < i
+		digit_type inv[COUNT * (COUNT-1) / 2 + 1];
+		
+		Moduli() {
+			operation_type n = ((operation_type)1 << 31) - 1;
+			for (len_type i=0; i<COUNT; ++i, n-=2) {
+				while (!bignum_is_prime_digit(n)) n -= 2;
+				p[i] = n;
+			}
+			for (len_type i=1; i<COUNT; ++i) {
+				for (len_type j=0; j<i; ++j) {
+					inv[i*(i-1)/2 + j] = bignum_pow_mod_digit(p[j], p[i] - 2, p[i]);
+				}
+			}
+		}
+	};
+	
+	// computed once per COUNT
+	static const Moduli& moduli() {
+		static const Moduli m;
+		return m;
+	}
+	
+	digit_type residues[COUNT];
+	
+public:
+	BigNumRNS() {
+		for (len_type i=0; i<COUNT; ++i) residues[i] = 0;
+	}
+	
+	BigNumRNS(const operation_type n) {
+		const Moduli &m = moduli();
+		for (len_type i=0; i<COUNT; ++i) residues[i] = n % m.p[i];
+	}
+	
+	explicit BigNumRNS(const BigNumView<BASE> &b) {
+		const Moduli &m = moduli();
+		for (len_type i=0; i<COUNT; ++i) residues[i] = UnsignedBigNum::mod_static(b, m.p[i]);
+	}
+	
+	explicit BigNumRNS(const UnsignedBigNum &b) : BigNumRNS(b.view()) {}
+	
+	static operation_type modulus(const len_type i) {
+		assert(i < COUNT);
+		return moduli().p[i];
+	}
+	
+	// value modulo product of primes, it must fit in UnsignedBigNum
+	UnsignedBigNum value() const {
+		const Moduli &m = moduli();
+		// mixed radix digits: value = v[0] + v[1]*p[0] + v[2]*p[0]*p[1] + ...
+		digit_type v[COUNT];
+		for (len_type i=0; i<COUNT; ++i) {
+			const operation_type p = m.p[i];
+			operation_type x = residues[i];
+			for (len_type j=0; j<i; ++j) {
+				x = (x + p - v[j] % p) * m.inv[i*(i-1)/2 + j] % p;
+			}
+			v[i] = x;
+		}
+		UnsignedBigNum result = v[COUNT-1];
+		for (len_type i=COUNT-1; i>0; --i) {
+			result *= m.p[i-1];
+			result += v[i-1];
+		}
+		return result;
+	}
+	
+	bool operator==(const BigNumRNS &b) const {
+		return std::equal(residues, residues + COUNT, b.residues);
+	}
+	
+	bool operator!=(const BigNumRNS &b) const {
+		return !(*this == b);
+	}
+	
+	BigNumRNS& operator +=(const BigNumRNS &b) {
+		const Moduli &m = moduli();
+		for (len_type i=0; i<COUNT; ++i) {
+			const digit_type s = residues[i] + b.residues[i];
+			residues[i] = (s >= m.p[i] ? s - m.p[i] : s);
+		}
+		return *this;
+	}
+	
+	// wraps modulo product of primes if b > self
+	BigNumRNS& operator -=(const BigNumRNS &b) {
+		const Moduli &m = moduli();
+		for (len_type i=0; i<COUNT; ++i) {
+			residues[i] = (residues[i] >= b.residues[i] ?
+				residues[i] - b.residues[i] :
+				residues[i] + m.p[i] - b.residues[i]
+			);
+		}
+		return *this;
+	}
+	
+	BigNumRNS& operator *=(const BigNumRNS &b) {
+		const Moduli &m = moduli();
+		for (len_type i=0; i<COUNT; ++i) {
+			residues[i] = (operation_type)residues[i] * b.residues[i] % m.p[i];
+		}
+		return *this;
+	}
+	
+	BigNumRNS operator+(const BigNumRNS &b) const {
+		BigNumRNS result = *this;
+		result += b;
+		return result;
+	}
+	
+	BigNumRNS operator-(const BigNumRNS &b) const {
+		BigNumRNS result = *this;
+		result -= b;
+		return result;
+	}
+	
+	BigNumRNS operator*(const BigNumRNS &b) const {
+		BigNumRNS result = *this;
+		result *= b;
+		return result;
+	}
 };
 
 #endif/*BIGNUM_H*/
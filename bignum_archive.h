@@ -0,0 +1,116 @@
+#ifndef BIGNUM_ARCHIVE_H
+#define BIGNUM_ARCHIVE_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+
+#include "bignum.h"
+
+// read-only memory-mapped file of bignumbers written by BigNum::fwrite_binary
+// records must be written in native byte order with the same BASE
+// views are valid until archive is closed
+template<operation_type BASE>
+class BigNumArchive {
+private:
+	typedef typename BigNumLimb<BASE>::type digit_type;
+	
+	const uint8_t *data;
+	size_t size;
+	std::vector< BigNumView<BASE> > entries;
+	
+	BigNumArchive(const BigNumArchive &) = delete;
+	BigNumArchive& operator=(const BigNumArchive &) = delete;
+	
+	bool index() {
+		size_t offset = 0;
+		while (offset < size) {
+			bignum_binary_header header;
+			if (size - offset < sizeof(header)) return false;
+			memcpy(&header, data + offset, sizeof(header));
+			if (memcmp(header.magic, BIGNUM_BINARY_MAGIC, sizeof(header.magic)) != 0) return false;
+			if (header.endian != bignum_native_endian()) return false;
+			if (header.digit_size != sizeof(digit_type)) return false;
+			if (header.base != BASE || header.len >= LEN_TYPE_MAX) return false;
+			const size_t record_size = bignum_binary_size(header.len, sizeof(digit_type));
+			if (size - offset < record_size) return false;
+			BigNumView<BASE> v = {
+				(const digit_type *)(data + offset + sizeof(header)),
+				(len_type)header.len
+			};
+			if (!bignum_binary_digits_valid(v.digits, v.len, BASE)) return false;
+			entries.push_back(v);
+			offset += record_size;
+		}
+		return true;
+	}
+	
+public:
+	BigNumArchive() : data(NULL), size(0) {}
+	
+	~BigNumArchive() {
+		close();
+	}
+	
+	// returns: success
+	bool open(const char *path) {
+		close();
+		int fd = ::open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			::close(fd);
+			return false;
+		}
+		size = st.st_size;
+		if (size > 0) {
+			void *addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+			if (addr == MAP_FAILED) {
+				::close(fd);
+				size = 0;
+				return false;
+			}
+			data = (const uint8_t *)addr;
+		}
+		::close(fd);
+		if (!index()) {
+			close();
+			return false;
+		}
+		return true;
+	}
+	
+	void close() {
+		if (data != NULL) munmap((void *)data, size);
+		data = NULL;
+		size = 0;
+		entries.clear();
+	}
+	
+	size_t count() const {
+		return entries.size();
+	}
+	
+	BigNumView<BASE> operator[](const size_t i) const {
+		assert(i < entries.size());
+		return entries[i];
+	}
+	
+	// b = record i, record may be longer than MyBigNum::max_len
+	// returns: success (record fits in MyBigNum)
+	template<class MyBigNum>
+	bool get(const size_t i, MyBigNum *b) const {
+		static_assert(MyBigNum::base == BASE, "BASE differs");
+		assert(i < entries.size());
+		if (entries[i].len > MyBigNum::max_len) return false;
+		*b = MyBigNum(entries[i]);
+		return true;
+	}
+};
+
+#endif/*BIGNUM_ARCHIVE_H*/
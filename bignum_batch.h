@@ -0,0 +1,119 @@
+#ifndef BIGNUM_BATCH_H
+#define BIGNUM_BATCH_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bignum.h"
+
+// fixed pool of worker threads which run the same job
+class BigNumThreadPool {
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable start, done;
+	std::function<void(unsigned int)> job;
+	// incremented for each job
+	unsigned long generation;
+	unsigned int running;
+	bool stopping;
+	
+	BigNumThreadPool(const BigNumThreadPool &) = delete;
+	BigNumThreadPool& operator=(const BigNumThreadPool &) = delete;
+	
+	void work(const unsigned int index) {
+		unsigned long seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			start.wait(lock, [&]{ return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+			lock.unlock();
+			job(index);
+			lock.lock();
+			if (--running == 0) done.notify_one();
+		}
+	}
+	
+public:
+	// count = 0: one worker per hardware thread
+	explicit BigNumThreadPool(unsigned int count = 0) : generation(0), running(0), stopping(false) {
+		if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned int i=0; i<count; ++i) {
+			workers.emplace_back(&BigNumThreadPool::work, this, i);
+		}
+	}
+	
+	~BigNumThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		start.notify_all();
+		for (std::thread &worker : workers) worker.join();
+	}
+	
+	unsigned int size() const {
+		return workers.size();
+	}
+	
+	// calls f(worker index) on each worker, returns when all calls returned
+	// must not be called concurrently
+	void run(const std::function<void(unsigned int)> &f) {
+		std::unique_lock<std::mutex> lock(mutex);
+		assert(running == 0);
+		job = f;
+		running = workers.size();
+		++generation;
+		start.notify_all();
+		done.wait(lock, [&]{ return running == 0; });
+	}
+};
+
+// calls f(i, scratch) for i < count on pool workers, each worker owns one Scratch;
+// items are split into equal contiguous ranges by worker index,
+// so item results do not depend on scheduling
+template<class Scratch, typename F>
+void bignum_batch(BigNumThreadPool &pool, const size_t count, F f) {
+	const size_t workers = pool.size();
+	pool.run([&](unsigned int index) {
+		const size_t begin = count * index / workers, end = count * (index + 1) / workers;
+		if (begin == end) return;
+		Scratch scratch;
+		for (size_t i=begin; i<end; ++i) f(i, scratch);
+	});
+}
+
+// a[i]*x[i] - b[i]*y[i] = c[i] by BigNum::linear_diophantine
+// success[i] is its result, x[i] and y[i] are undefined if it is false
+template<class MyBigNum>
+void linear_diophantine_batch(
+	BigNumThreadPool &pool,
+	const MyBigNum *a, const MyBigNum *b, const MyBigNum *c, const size_t count,
+	MyBigNum *x, MyBigNum *y, bool *success
+) {
+	typedef typename MyBigNum::LinearDiophantineScratch Scratch;
+	bignum_batch<Scratch>(pool, count, [&](size_t i, Scratch &scratch) {
+		success[i] = MyBigNum::linear_diophantine(a[i], b[i], c[i], &x[i], &y[i], scratch);
+	});
+}
+
+// a[i]*x[i] - b[i]*y[i] = gcd[i] by BigNum::extended_binary_euclidean
+template<class MyBigNum>
+void extended_binary_euclidean_batch(
+	BigNumThreadPool &pool,
+	const MyBigNum *a, const MyBigNum *b, const size_t count,
+	MyBigNum *x, MyBigNum *y, MyBigNum *gcd
+) {
+	struct NoScratch {};
+	bignum_batch<NoScratch>(pool, count, [&](size_t i, NoScratch &) {
+		MyBigNum::extended_binary_euclidean(a[i], b[i], &x[i], &y[i], &gcd[i]);
+	});
+}
+
+#endif/*BIGNUM_BATCH_H*/
@@ -0,0 +1,69 @@
+// throughput of primality testing: random odd candidates and primes tested per second
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bignum.h"
+
+static uint64_t xorshift() {
+	static uint64_t x = 88172645463325252llu;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return x;
+}
+
+static double now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template<operation_type BASE, len_type MAX_LEN>
+static BigNum<BASE, MAX_LEN> random_odd(const len_type len) {
+	typename BigNumLimb<BASE>::type digits[MAX_LEN];
+	for (len_type i=0; i<len; ++i) digits[i] = xorshift() % BASE;
+	digits[0] |= 1;
+	if (digits[len-1] == 0) digits[len-1] = 1;
+	return BigNum<BASE, MAX_LEN>(len, digits);
+}
+
+// calls f for at least 1 second, returns: calls per second
+template<typename F>
+static double rate(F f) {
+	unsigned int count = 0;
+	const double start = now_s();
+	double elapsed;
+	do {
+		f();
+		++count;
+		elapsed = now_s() - start;
+	} while (elapsed < 1.0);
+	return count / elapsed;
+}
+
+template<operation_type BASE, len_type LEN>
+static void bench_prime(const char *name) {
+	typedef BigNum<BASE, LEN + 1> MyBigNum;
+	unsigned int found = 0;
+	const double candidates = rate([&]{
+		found += random_odd<BASE, LEN + 1>(LEN).is_probable_prime();
+	});
+	MyBigNum prime = random_odd<BASE, LEN + 1>(LEN);
+	while (!prime.is_probable_prime()) prime += 2;
+	const double bpsw = rate([&]{ found += prime.is_probable_prime(); });
+	const double mr = rate([&]{ found += prime.is_probable_prime(false); });
+	printf("%-12s %5u limbs: %10.1f candidates/s, %8.2f primes/s (BPSW), %8.2f primes/s (Miller-Rabin, 12 bases)\n",
+		name, (unsigned int)LEN, candidates, bpsw, mr);
+	fflush(stdout);
+}
+
+int main() {
+	bench_prime<0x100000000llu, 8>("2^32");
+	bench_prime<0x100000000llu, 32>("2^32");
+	bench_prime<0x100000000llu, 128>("2^32");
+	bench_prime<1000000000, 9>("10^9");
+	bench_prime<1000000000, 35>("10^9");
+	bench_prime<1000000000, 137>("10^9");
+	return 0;
+}
@@ -0,0 +1,172 @@
+#ifndef BIGNUM_SHARED_H
+#define BIGNUM_SHARED_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bignum.h"
+
+// reference-counted immutable bignumber, copies of handle share the value
+// mutate() promotes handle to its own mutable copy if value is shared (copy-on-write)
+template<class MyBigNum>
+class BigNumShared {
+private:
+	struct Stored {
+		MyBigNum value;
+		// count of handles and table entries referring to value:
+		// released with release ordering and checked by mutate() with acquire ordering,
+		// so the only owner sees all accesses of former owners
+		std::atomic<size_t> refs;
+		
+		explicit Stored(const MyBigNum &v) : value(v), refs(1) {}
+	};
+	
+	// NULL for zero, so empty handles never touch a reference count
+	Stored *stored;
+	
+	static Stored* retain(Stored *s) {
+		if (s != NULL) s->refs.fetch_add(1, std::memory_order_relaxed);
+		return s;
+	}
+	
+	static void release(Stored *s) {
+		if (s != NULL && s->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete s;
+	}
+	
+	static const MyBigNum& zero() {
+		static const MyBigNum z;
+		return z;
+	}
+	
+	template<class B>
+	friend class BigNumInternTable;
+	
+	// takes over reference s
+	explicit BigNumShared(Stored *s) : stored(s) {}
+	
+public:
+	BigNumShared() : stored(NULL) {}
+	
+	explicit BigNumShared(const MyBigNum &b) : stored(new Stored(b)) {}
+	
+	BigNumShared(const BigNumShared &b) : stored(retain(b.stored)) {}
+	
+	BigNumShared(BigNumShared &&b) : stored(b.stored) {
+		b.stored = NULL;
+	}
+	
+	~BigNumShared() {
+		release(stored);
+	}
+	
+	BigNumShared& operator=(const BigNumShared &b) {
+		Stored *s = retain(b.stored);
+		release(stored);
+		stored = s;
+		return *this;
+	}
+	
+	BigNumShared& operator=(BigNumShared &&b) {
+		std::swap(stored, b.stored);
+		return *this;
+	}
+	
+	const MyBigNum& get() const {
+		return (stored != NULL ? stored->value : zero());
+	}
+	
+	const MyBigNum& operator*() const {
+		return get();
+	}
+	
+	const MyBigNum* operator->() const {
+		return &get();
+	}
+	
+	operator const MyBigNum&() const {
+		return get();
+	}
+	
+	// whether handles refer to the same stored value
+	bool shares(const BigNumShared &b) const {
+		return stored == b.stored;
+	}
+	
+	// value owned only by this handle, copied if it is shared;
+	// copies of handle may be used by other threads, but not this handle object
+	MyBigNum& mutate() {
+		if (stored == NULL) {
+			stored = new Stored(zero());
+		} else if (stored->refs.load(std::memory_order_acquire) != 1) {
+			Stored *s = new Stored(stored->value);
+			release(stored);
+			stored = s;
+		}
+		return stored->value;
+	}
+};
+
+// table of interned values: equal values are stored once and are kept
+// until the table is destroyed, global() table lives until exit;
+// table is guarded by mutex, interned handles may be used by any thread
+template<class MyBigNum>
+class BigNumInternTable {
+private:
+	typedef typename BigNumShared<MyBigNum>::Stored Stored;
+	
+	std::mutex mutex;
+	// by hash of digits, each entry holds a reference
+	std::unordered_map< size_t, std::vector<Stored *> > buckets;
+	size_t count;
+	
+	BigNumInternTable(const BigNumInternTable &) = delete;
+	BigNumInternTable& operator=(const BigNumInternTable &) = delete;
+	
+	// FNV-1a over digits
+	static size_t hash(const BigNumView<MyBigNum::base> &b) {
+		uint64_t h = 14695981039346656037llu;
+		for (len_type i=0; i<b.len; ++i) {
+			h = (h ^ b.digits[i]) * 1099511628211llu;
+		}
+		return h;
+	}
+	
+public:
+	BigNumInternTable() : count(0) {}
+	
+	// values stay alive while handles refer to them
+	~BigNumInternTable() {
+		for (auto &bucket : buckets) {
+			for (Stored *s : bucket.second) BigNumShared<MyBigNum>::release(s);
+		}
+	}
+	
+	static BigNumInternTable& global() {
+		static BigNumInternTable table;
+		return table;
+	}
+	
+	BigNumShared<MyBigNum> intern(const MyBigNum &b) {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<Stored *> &bucket = buckets[hash(b.view())];
+		for (Stored *s : bucket) {
+			if (s->value == b) return BigNumShared<MyBigNum>(BigNumShared<MyBigNum>::retain(s));
+		}
+		bucket.push_back(new Stored(b));
+		++count;
+		return BigNumShared<MyBigNum>(BigNumShared<MyBigNum>::retain(bucket.back()));
+	}
+	
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return count;
+	}
+};
+
+#endif/*BIGNUM_SHARED_H*/
@@ -2,8 +2,14 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "bignum.h"
+#include "bignum_archive.h"
+#include "bignum_batch.h"
+#include "bignum_shared.h"
 
 void test_assign() {
 	BigNum<10, 2> a;
@@ -72,7 +78,7 @@ void test_sub() {
 
 void test_div() {
 	unsigned int i, j, k, l;
-	digit_type remaind;
+	BigNum<10, 3>::digit_type remaind;
 	BigNum<10, 3> a, b, c;
 	for (j=1; j<10; ++j) {
 		for (i=0; i<1000; ++i) {
@@ -219,6 +225,814 @@ void test_linear_diophantine() {
 	}
 }
 
+void test_binary_archive() {
+	typedef BigNum<0x100000000llu, 64> MyBigNum;
+	char path[] = "/tmp/bignum_tests_XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	FILE *stream = fdopen(fd, "w+b");
+	assert(stream != NULL);
+	MyBigNum n, a[16];
+	for (unsigned int i=0; i<16; ++i) {
+		n = i + 1;
+		a[i] = n.pow(i * 7);
+		bool res = a[i].fwrite_binary(stream);
+		assert(res);
+	}
+	rewind(stream);
+	for (unsigned int i=0; i<16; ++i) {
+		bool res = n.fread_binary(stream);
+		assert(res);
+		assert(n == a[i]);
+	}
+	fclose(stream);
+	
+	BigNumArchive<0x100000000llu> archive;
+	bool res = archive.open(path);
+	assert(res);
+	assert(archive.count() == 16);
+	for (unsigned int i=0; i<16; ++i) {
+		n = MyBigNum(archive[i]);
+		assert(n == a[i]);
+	}
+	// records longer than target are rejected
+	BigNum<0x100000000llu, 4> small;
+	for (unsigned int i=0; i<16; ++i) {
+		res = archive.get(i, &small);
+		assert(res == (a[i].view().len <= 4));
+		assert(!res || small == MyBigNum(a[i]));
+		res = archive.get(i, &n);
+		assert(res && n == a[i]);
+	}
+	assert(!BigNumArchive<1000000000>().open(path));
+	
+	// records with digits >= BASE or with leading zero are rejected
+	typedef BigNum<1000000000, 4> DecBigNum;
+	DecBigNum d;
+	const uint32_t bad_digits[2][2] = {{1000000000, 1}, {1, 0}};
+	for (unsigned int i=0; i<2; ++i) {
+		stream = fopen(path, "w+b");
+		assert(stream != NULL);
+		res = DecBigNum(1234567).fwrite_binary(stream) && DecBigNum(1000000001).fwrite_binary(stream);
+		assert(res);
+		fseek(stream, -(long)sizeof(bad_digits[i]), SEEK_CUR);
+		fwrite(bad_digits[i], sizeof(bad_digits[i]), 1, stream);
+		rewind(stream);
+		res = d.fread_binary(stream);
+		assert(res && d == 1234567);
+		res = d.fread_binary(stream);
+		assert(!res);
+		fclose(stream);
+		assert(!BigNumArchive<1000000000>().open(path));
+	}
+	unlink(path);
+}
+
+len_type to_decimal_digits(unsigned int n, BigNumView<10>::digit_type digits[]) {
+	len_type len = 0;
+	while (n > 0) {
+		digits[len++] = n % 10;
+		n /= 10;
+	}
+	return len;
+}
+
+void test_view() {
+	typedef BigNum<10, 8> MyBigNum;
+	typedef BigNumView<10> MyView;
+	typedef BigNumSpan<10> MySpan;
+	unsigned int i, j;
+	MyBigNum::digit_type a_digits[8], b_digits[8], c_digits[8], remaind;
+	MyBigNum d;
+	for (i=0; i<3000; i+=7) {
+		for (j=1; j<3000; j+=13) {
+			MyView a = {a_digits, to_decimal_digits(i, a_digits)};
+			MyView b = {b_digits, to_decimal_digits(j, b_digits)};
+			MyView c = {c_digits, 0};
+			MySpan result = {c_digits, 8};
+			assert((a < b) == (i < j));
+			assert((a == b) == (i == j));
+			assert((a != b) == (i != j));
+			assert(a == MyBigNum(i));
+			c.len = MyBigNum::add_static(result, a, b);
+			assert(c == MyBigNum(i + j));
+			if (i >= j) {
+				c.len = MyBigNum::sub_static(result, a, b);
+				assert(c == MyBigNum(i - j));
+			}
+			c.len = MyBigNum::mul_static(result, a, b);
+			assert(c == MyBigNum(i * j));
+			c.len = MyBigNum::div_static(result, a, b, &d);
+			assert(c == MyBigNum(i / j));
+			assert(d == MyBigNum(i % j));
+			if (j < 10) {
+				c.len = MyBigNum::div_static(result, a, (MyBigNum::digit_type)j, &remaind);
+				assert(c == MyBigNum(i / j));
+				assert(remaind == i % j);
+			}
+		}
+	}
+}
+
+template<class MyBigNum>
+void test_scalar_base() {
+	const uint_fast64_t values[] = {
+		0, 1, 2, 9, 10, 15, 16, 99, 1000, 65535, 65536, 999999999, 1000000000,
+		0xFFFFFFFFu, 0x100000000llu, 12345678901234llu, 0xFFFFFFFFFFFFllu
+	};
+	const size_t count = sizeof(values) / sizeof(values[0]);
+	uint_fast64_t remaind;
+	char expected[32], printed[32];
+	for (size_t i=0; i<count; ++i) {
+		for (size_t j=0; j<count; ++j) {
+			const uint_fast64_t x = values[i], y = values[j];
+			MyBigNum a = x, b;
+			b = a + y;
+			assert(b.value() == x + y);
+			b = a; b += y;
+			assert(b.value() == x + y);
+			if (x >= y) {
+				b = a - y;
+				assert(b.value() == x - y);
+				b = a; b -= y;
+				assert(b.value() == x - y);
+			}
+			if (y == 0 || x <= UINT64_MAX / y) {
+				b = a * y;
+				assert(b.value() == x * y);
+				b = a; b *= y;
+				assert(b.value() == x * y);
+			}
+			if (y > 0) {
+				b = a.div(y, &remaind);
+				assert(b.value() == x / y);
+				assert(remaind == x % y);
+				assert(a % y == x % y);
+				b = a; b /= y;
+				assert(b.value() == x / y);
+			}
+		}
+		FILE *stream = tmpfile();
+		assert(stream != NULL);
+		MyBigNum(values[i]).fprintd(stream);
+		rewind(stream);
+		size_t printed_len = fread(printed, 1, sizeof(printed)-1, stream);
+		printed[printed_len] = '\0';
+		fclose(stream);
+		sprintf(expected, "%" PRIuFAST64, values[i]);
+		assert(strcmp(printed, expected) == 0);
+	}
+}
+
+void test_scalar() {
+	test_scalar_base< BigNum<10, 40> >();
+	test_scalar_base< BigNum<16, 32> >();
+	test_scalar_base< BigNum<1000000000, 6> >();
+	test_scalar_base< BigNum<0x100000000llu, 6> >();
+}
+
+template<class From, class To>
+void test_radix_pair(const From &a) {
+	To b = a;
+	From c = b;
+	assert(c == a);
+	char a_printed[4096], b_printed[4096];
+	FILE *stream = tmpfile();
+	assert(stream != NULL);
+	a.fprintd(stream);
+	fputc(' ', stream);
+	b.fprintd(stream);
+	rewind(stream);
+	int res = fscanf(stream, "%4095s %4095s", a_printed, b_printed);
+	assert(res == 2);
+	fclose(stream);
+	assert(strcmp(a_printed, b_printed) == 0);
+}
+
+void test_radix() {
+	typedef BigNum<10, 1200> Dec1;
+	typedef BigNum<1000, 400> Dec3;
+	typedef BigNum<1000000000, 140> Dec9;
+	typedef BigNum<16, 1000> Hex1;
+	typedef BigNum<0x10000, 250> Bin16;
+	typedef BigNum<0x100000000llu, 125> Bin32;
+	Bin32 n;
+	for (unsigned int i=0; i<=1000; i+=37) {
+		n = 3;
+		n.pow_assign(i);
+		test_radix_pair<Bin32, Bin16>(n);
+		test_radix_pair<Bin32, Hex1>(n);
+		test_radix_pair<Bin32, Dec9>(n);
+		test_radix_pair<Bin32, Dec3>(n);
+		test_radix_pair<Bin32, Dec1>(n);
+		test_radix_pair<Dec9, Dec1>(n);
+		test_radix_pair<Dec9, Dec3>(n);
+		test_radix_pair<Dec3, Bin16>(n);
+	}
+	// targets without spare digits: 2^1024 has 33 digits of 2^32, 35 of 10^9, 309 of 10
+	typedef BigNum<0x100000000llu, 33> TightBin32;
+	typedef BigNum<1000000000, 35> TightDec9;
+	typedef BigNum<10, 309> TightDec1;
+	TightBin32 t;
+	for (unsigned int i=1000; i<=1024; i+=8) {
+		t = 2;
+		t.pow_assign(i);
+		test_radix_pair<TightBin32, TightDec9>(t);
+		test_radix_pair<TightBin32, TightDec1>(t);
+		test_radix_pair<TightDec9, TightDec1>(TightDec9(t));
+		assert(t.to_string() == TightDec9(t).to_string());
+	}
+	t -= 1;
+	test_radix_pair<TightBin32, TightDec9>(t);
+	test_radix_pair<TightDec1, TightBin32>(TightDec1(t));
+}
+
+uint_fast64_t xorshift_state = 88172645463325252llu;
+
+uint_fast64_t xorshift() {
+	xorshift_state ^= xorshift_state << 13;
+	xorshift_state ^= xorshift_state >> 7;
+	xorshift_state ^= xorshift_state << 17;
+	return xorshift_state;
+}
+
+template<operation_type BASE>
+void test_mul_columns_base() {
+	typedef BigNum<BASE, 128> MyBigNum;
+	typedef BigNumView<BASE> MyView;
+	typedef BigNumSpan<BASE> MySpan;
+	typename MyBigNum::digit_type a_digits[64], b_digits[64], rows_digits[128], cols_digits[128];
+	for (len_type a_len=1; a_len<=64; a_len+=7) {
+		for (len_type b_len=1; b_len<=64; b_len+=5) {
+			for (len_type i=0; i<a_len; ++i) a_digits[i] = xorshift() % BASE;
+			for (len_type i=0; i<b_len; ++i) b_digits[i] = xorshift() % BASE;
+			a_digits[a_len-1] = b_digits[b_len-1] = BASE - 1;
+			MyView a = {a_digits, a_len}, b = {b_digits, b_len};
+			MySpan rows_span = {rows_digits, 128}, cols_span = {cols_digits, 128};
+			MyView rows = {rows_digits, MyBigNum::mul_rows_static(rows_span, a, b)};
+			MyView cols = {cols_digits, MyBigNum::mul_static(cols_span, a, b)};
+			assert(rows == cols);
+		}
+	}
+}
+
+void test_mul_columns() {
+	test_mul_columns_base<10>();
+	test_mul_columns_base<10000>();
+	test_mul_columns_base<1000000000>();
+	test_mul_columns_base<0x100000000llu>();
+}
+
+int64_t signed_value(const SignedBigNum< BigNum<10, 4> > &a) {
+	int64_t v = a.abs().value();
+	return (a.is_negative() ? -v : v);
+}
+
+void test_signed() {
+	typedef BigNum<10, 4> MyBigNum;
+	typedef SignedBigNum<MyBigNum> MySignedBigNum;
+	int64_t i, j;
+	for (i=-60; i<=60; ++i) {
+		for (j=-60; j<=60; ++j) {
+			MySignedBigNum a(MyBigNum(i < 0 ? -i : i), i < 0);
+			MySignedBigNum b(MyBigNum(j < 0 ? -j : j), j < 0);
+			assert(signed_value(a) == i);
+			assert((a < b) == (i < j));
+			assert((a == b) == (i == j));
+			assert(signed_value(a + b) == i + j);
+			assert(signed_value(a - b) == i - j);
+			assert(signed_value(a * b) == i * j);
+			assert(signed_value(-a) == -i);
+			MySignedBigNum c(a);
+			c -= b.abs();
+			assert(signed_value(c) == i - (j < 0 ? -j : j));
+			if (i % 2 == 0) {
+				c = a;
+				c.div2_assign();
+				assert(signed_value(c) == i / 2);
+			}
+			c = a - a;
+			assert(!c.is_negative());
+		}
+	}
+}
+
+template<operation_type BASE>
+void test_divexact_base() {
+	typedef BigNum<BASE, 64> MyBigNum;
+	typename MyBigNum::digit_type q_digits[32], b_digits[32];
+	for (len_type q_len=1; q_len<=32; q_len+=3) {
+		for (len_type b_len=1; b_len<=32; b_len+=4) {
+			for (len_type i=0; i<q_len; ++i) q_digits[i] = xorshift() % BASE;
+			for (len_type i=0; i<b_len; ++i) b_digits[i] = xorshift() % BASE;
+			q_digits[q_len-1] = b_digits[b_len-1] = 1;
+			if (b_len > 2) b_digits[0] = 0;
+			if (b_len > 3) b_digits[1] = BASE / 2;
+			MyBigNum q(q_len, q_digits), b(b_len, b_digits);
+			MyBigNum a = q * b;
+			assert(a.divexact(b) == q);
+			assert(a.divexact(q) == b);
+			a.divexact_assign(b);
+			assert(a == q);
+		}
+	}
+}
+
+void test_divexact() {
+	test_divexact_base<10>();
+	test_divexact_base<1000000000>();
+	test_divexact_base<0x10000>();
+	test_divexact_base<0x100000000llu>();
+}
+
+void test_mul_wide() {
+	typedef BigNum<0x100000000llu, 20> Narrow;
+	typedef BigNum<0x100000000llu, 12> Short;
+	typedef BigNum<0x100000000llu, 32> Wide;
+	Narrow::digit_type a_digits[20], b_digits[12];
+	for (len_type a_len=1; a_len<=20; ++a_len) {
+		for (len_type b_len=1; b_len<=12; ++b_len) {
+			for (len_type i=0; i<a_len; ++i) a_digits[i] = xorshift();
+			for (len_type i=0; i<b_len; ++i) b_digits[i] = xorshift();
+			a_digits[a_len-1] |= 1; b_digits[b_len-1] |= 1;
+			Narrow a(a_len, a_digits), q, r;
+			Short b(b_len, b_digits);
+			Wide product = a.mul_wide(b);
+			assert(product == Wide(a) * Wide(b));
+			Narrow::divmod(product, Narrow(b), &q, &r);
+			assert(q == a);
+			assert(r == 0);
+			product += 12345;
+			Narrow::divmod(product, Narrow(b), NULL, &r);
+			assert(Wide(r) == product % Wide(b));
+			if (a_len == 20) continue;
+			Narrow::divmod(product, a, &q, &r);
+			assert(Wide(q) == product / Wide(a));
+			assert(Wide(r) == product % Wide(a));
+		}
+	}
+}
+
+typedef BigNum<0x100000000llu, 8> ConstBigNum;
+
+constexpr ConstBigNum const_powers[] = {
+	ConstBigNum(1),
+	ConstBigNum(1000000000),
+	ConstBigNum(1000000000).pow(2),
+	ConstBigNum(1000000000).pow(3),
+	ConstBigNum(1000000000).pow(4) + 7,
+};
+
+constexpr ConstBigNum const_remainder(const ConstBigNum &a, const ConstBigNum &b) {
+	ConstBigNum remaind;
+	a.div(b, &remaind);
+	return remaind;
+}
+
+static_assert(const_powers[2] == const_powers[1] * const_powers[1], "constexpr mul");
+static_assert(const_powers[1].shift_left(2) == const_powers[1] * ConstBigNum(0x100000000llu).pow(2), "constexpr shift_left");
+static_assert(const_powers[1].shift_left(0) == const_powers[1], "constexpr shift_left");
+static_assert(const_powers[3] / const_powers[1] == const_powers[2], "constexpr div");
+static_assert(const_powers[3] - const_powers[2] + const_powers[2] == const_powers[3], "constexpr add, sub");
+static_assert(const_remainder(const_powers[4], const_powers[3]) == 7, "constexpr remainder");
+static_assert(ConstBigNum(0xFFFFFFFFFFFFFFFFllu).value() == 0xFFFFFFFFFFFFFFFFllu, "constexpr value");
+
+void test_constexpr() {
+	ConstBigNum n = 1000000000;
+	for (unsigned int i=0; i<4; ++i) {
+		assert(const_powers[i] == n.pow(i));
+	}
+	assert(const_powers[4] == n.pow(4) + 7);
+}
+
+template<class MyBigNum>
+void test_to_chars_base() {
+	char expected[32], buffer[32];
+	for (uint_fast64_t i=0; i<UINT64_MAX/3; i=i*3+1) {
+		MyBigNum a = i;
+		sprintf(expected, "%" PRIuFAST64, i);
+		const size_t expected_len = strlen(expected);
+		char *end = a.to_chars(buffer, buffer + sizeof(buffer));
+		assert(end == buffer + expected_len);
+		assert(memcmp(buffer, expected, expected_len) == 0);
+		assert(a.to_chars(buffer, buffer + expected_len - 1) == NULL);
+		assert(a.to_string() == expected);
+	}
+}
+
+void test_to_chars() {
+	test_to_chars_base< BigNum<2, 64> >();
+	test_to_chars_base< BigNum<10, 20> >();
+	test_to_chars_base< BigNum<16, 16> >();
+	test_to_chars_base< BigNum<1000, 7> >();
+	test_to_chars_base< BigNum<0x100000000llu, 2> >();
+	
+	typedef BigNum<0x100000000llu, 2000> MyBigNum;
+	MyBigNum a = 7;
+	a.pow_assign(20000);
+	const std::string decimal = a.to_string();
+	assert(decimal.size() > DEC_WRITE_BUFFER_SIZE * 2);
+	std::string chunked;
+	size_t chunks = 0;
+	a.write_decimal([&](const char *data, size_t size) {
+		assert(size > 0 && size <= DEC_WRITE_BUFFER_SIZE);
+		chunked.append(data, size);
+		++chunks;
+	});
+	assert(chunked == decimal);
+	assert(chunks > 2);
+	MyBigNum b;
+	for (size_t i=0; i<decimal.size(); ++i) {
+		b *= 10;
+		b += decimal[i] - '0';
+	}
+	assert(a == b);
+}
+
+template<operation_type BASE>
+void test_accumulator_base() {
+	typedef BigNum<BASE, 24> MyBigNum;
+	typename MyBigNum::digit_type a_digits[8], b_digits[8];
+	BigNumAccumulator<MyBigNum> acc;
+	MyBigNum expected;
+	for (unsigned int k=0; k<1000; ++k) {
+		const len_type a_len = xorshift() % 9, b_len = xorshift() % 9;
+		for (len_type i=0; i<a_len; ++i) a_digits[i] = xorshift() % BASE;
+		for (len_type i=0; i<b_len; ++i) b_digits[i] = xorshift() % BASE;
+		if (a_len > 0) a_digits[a_len-1] |= 1;
+		if (b_len > 0) b_digits[b_len-1] |= 1;
+		const MyBigNum a(a_len, a_digits), b(b_len, b_digits);
+		if (k % 3 == 0) {
+			acc += a;
+			expected += a;
+		} else {
+			acc.add_mul(a, b);
+			expected += a * b;
+		}
+		if (k % 100 == 99) assert(acc.value() == expected);
+	}
+	assert(acc.value() == expected);
+	acc.clear();
+	assert(acc.value() == 0);
+}
+
+void test_accumulator() {
+	test_accumulator_base<10>();
+	test_accumulator_base<1000000000>();
+	test_accumulator_base<0x100000000llu>();
+}
+
+template<class MyBigNum>
+void test_rns_base() {
+	typedef BigNumRNS<MyBigNum> MyRNS;
+	// polynomial of degree 7 at x: Horner's method in both representations
+	for (unsigned int k=0; k<100; ++k) {
+		const operation_type x = xorshift() % 1000000 + 1;
+		MyBigNum expected;
+		MyRNS rns;
+		for (unsigned int i=0; i<8; ++i) {
+			const operation_type coef = xorshift() % 1000000000;
+			expected = expected * MyBigNum(x) + MyBigNum(coef);
+			rns = rns * MyRNS(x) + MyRNS(coef);
+		}
+		assert(MyRNS(expected) == rns);
+		assert(rns.value() == expected);
+		MyRNS half = MyRNS(expected / 2);
+		assert((rns - half).value() == expected - expected / 2);
+	}
+	// product of many factors
+	MyBigNum expected = 1;
+	MyRNS rns = 1;
+	for (operation_type i=2; i<=40; ++i) {
+		expected *= i;
+		rns *= MyRNS(MyBigNum(i));
+	}
+	assert(rns.value() == expected);
+	assert(MyRNS().value() == 0);
+}
+
+void test_rns() {
+	test_rns_base< BigNum<10, 60> >();
+	test_rns_base< BigNum<1000000000, 8> >();
+	test_rns_base< BigNum<0x100000000llu, 7> >();
+}
+
+bool is_prime_naive(const uint_fast64_t n) {
+	if (n < 2) return false;
+	for (uint_fast64_t d=2; d*d<=n; ++d) {
+		if (n % d == 0) return false;
+	}
+	return true;
+}
+
+template<class MyBigNum>
+void test_prime_base() {
+	for (uint_fast64_t n=0; n<2000; ++n) {
+		assert(MyBigNum(n).is_probable_prime() == is_prime_naive(n));
+	}
+	for (uint_fast64_t n=0xFFFFFFFFllu-3000; n<0xFFFFFFFFllu; ++n) {
+		const bool expected = is_prime_naive(n);
+		assert(MyBigNum(n).is_probable_prime() == expected);
+		assert(MyBigNum(n).is_probable_prime(false) == expected);
+	}
+	// strong pseudoprimes to bases 2, 3, 5, 7 and Carmichael numbers
+	assert(!MyBigNum(3215031751llu).is_probable_prime());
+	assert(!MyBigNum(2152302898747llu).is_probable_prime());
+	assert(!MyBigNum(3474749660383llu).is_probable_prime());
+	assert(!MyBigNum(41041).is_probable_prime());
+	assert(!MyBigNum(825265).is_probable_prime());
+	// Mersenne numbers 2^p - 1 are prime for p in mersenne_exponents only
+	static const unsigned int mersenne_exponents[] = {61, 89, 107, 127};
+	size_t next = 0;
+	for (unsigned int p=61; p<=128; ++p) {
+		MyBigNum m = 2;
+		m.pow_assign(p);
+		m -= 1;
+		const bool expected = (next < 4 && mersenne_exponents[next] == p);
+		if (expected) ++next;
+		assert(m.is_probable_prime() == expected);
+		assert(m.is_probable_prime(false) == expected);
+	}
+	// product of two primes above 2^64
+	MyBigNum a = 2, b = 2;
+	a.pow_assign(89); a -= 1;
+	b.pow_assign(61); b -= 1;
+	assert(a.is_probable_prime());
+	assert(!(a * b).is_probable_prime());
+	assert(!(a * b).is_probable_prime(false));
+	assert(!(a * a).is_probable_prime());
+	// strong pseudoprimes to the first 12 and 13 prime bases above 2^64:
+	// Miller-Rabin accepts them, strong Lucas test of BPSW must reject them
+	const MyBigNum psp[] = {
+		MyBigNum(399165290221llu) * MyBigNum(798330580441llu),
+		MyBigNum(1287836182261llu) * MyBigNum(2575672364521llu)
+	};
+	for (const MyBigNum &n : psp) {
+		assert(n.is_probable_prime(false));
+		assert(!n.is_probable_prime());
+	}
+}
+
+void test_prime() {
+	test_prime_base< BigNum<10, 80> >();
+	test_prime_base< BigNum<1000000000, 10> >();
+	test_prime_base< BigNum<0x10000, 20> >();
+	test_prime_base< BigNum<0x100000000llu, 10> >();
+	// BASE with prime factor > 1024, reduction by division for multiples of 1031
+	test_prime_base< BigNum<2 * 1031 * 1031, 14> >();
+	BigNum<2 * 1031 * 1031, 14> a = 2;
+	a.pow_assign(89);
+	a -= 1;
+	a *= 1031;
+	assert(!a.is_probable_prime());
+}
+
+template<class MyBigNum>
+void test_batch_inverse_base(const MyBigNum &m) {
+	MyBigNum values[50], inverses[50];
+	for (size_t i=0; i<50; ++i) {
+		values[i] = (MyBigNum(xorshift()) * MyBigNum(xorshift()) + MyBigNum(i)) % m;
+		if (m.is_even() && values[i].is_even()) values[i] += 1;
+	}
+	values[7] += m;
+	bool invertible = true;
+	for (size_t i=0; i<50; ++i) {
+		MyBigNum inverse;
+		invertible = MyBigNum::inverse_mod(values[i], m, &inverse) && invertible;
+	}
+	assert(MyBigNum::batch_inverse(values, 50, m, inverses) == invertible);
+	if (!invertible) return;
+	for (size_t i=0; i<50; ++i) {
+		assert(inverses[i] < m);
+		assert(values[i] * inverses[i] % m == 1);
+	}
+	assert(MyBigNum::batch_inverse(values, 1, m, inverses));
+	assert(values[0] * inverses[0] % m == 1);
+	values[3] = m * 2;
+	assert(!MyBigNum::batch_inverse(values, 50, m, inverses));
+}
+
+template<class MyBigNum>
+void test_crt_base() {
+	MyBigNum residues[40], moduli[40], x;
+	// powers of 2 and 3 and distinct primes
+	moduli[0] = MyBigNum(2).pow(40);
+	moduli[1] = MyBigNum(3).pow(25);
+	MyBigNum p = 1000003;
+	for (size_t i=2; i<40; ++i) {
+		do p += 2; while (!p.is_probable_prime());
+		moduli[i] = p;
+	}
+	for (size_t count=1; count<=40; count+=3) {
+		MyBigNum product = 1;
+		for (size_t i=0; i<count; ++i) {
+			residues[i] = MyBigNum(xorshift()) % moduli[i];
+			product *= moduli[i];
+		}
+		assert(MyBigNum::crt_combine(residues, moduli, count, &x));
+		assert(x < product);
+		for (size_t i=0; i<count; ++i) assert(x % moduli[i] == residues[i]);
+	}
+	// moduli are not coprime
+	moduli[5] = moduli[2] * 3;
+	assert(!MyBigNum::crt_combine(residues, moduli, 8, &x));
+}
+
+void test_batch_inverse() {
+	typedef BigNum<0x100000000llu, 40> MyBigNum;
+	MyBigNum m = 2;
+	m.pow_assign(521);
+	m -= 1;
+	test_batch_inverse_base(m);
+	test_batch_inverse_base(m * 6);
+	test_batch_inverse_base(MyBigNum(1000000007) * MyBigNum(998244353) * 5);
+	test_batch_inverse_base(BigNum<1000000000, 40>(m));
+	test_batch_inverse_base(BigNum<1000000000, 40>(m * 10));
+	test_crt_base<MyBigNum>();
+	test_crt_base< BigNum<1000000000, 40> >();
+}
+
+static_assert(std::is_same<BigNum<10, 2>::digit_type, uint8_t>::value, "limb of BASE 10");
+static_assert(std::is_same<BigNum<0x10000, 2>::digit_type, uint16_t>::value, "limb of BASE 2^16");
+static_assert(std::is_same<BigNum<0x10002, 2>::digit_type, uint32_t>::value, "limb of BASE 2^16+2");
+static_assert(sizeof(BigNum<10, 2>) == 3, "compact BigNum<10, 2>");
+static_assert(sizeof(BigNum<10000, 300>) == 602, "compact BigNum<10000, 300>");
+
+void test_storage() {
+	// values in compact storage near limits of limb and length types
+	typedef BigNum<256, 255> MyBigNum;
+	MyBigNum a = 255, b;
+	a.pow_assign(254);
+	b = a * 255;
+	assert(b.view().len == 255);
+	assert(b / a == 255);
+	typedef BigNum<1000000000, 70> Decimal;
+	assert(b.to_string() == Decimal(b).to_string());
+	BigNum<0x10000, 4> c = 0xFFFFFFFFFFFFFFFFllu;
+	assert(c.value() == 0xFFFFFFFFFFFFFFFFllu);
+	assert((c * BigNum<0x10000, 4>(1)).value() == 0xFFFFFFFFFFFFFFFFllu);
+	// scalar operands are not truncated to limb type
+	const BigNum<10, 4> d = 3, e = 259;
+	assert(d != 259 && !(d == 259) && d < 259 && d <= 259 && !(d > 259) && !(d >= 259));
+	assert(e == 259 && e > 258 && e < 260 && e >= 259 && e <= 259 && e != 3);
+	assert(c > 0xFFFFFFFFFFFFFFFEllu && c == 0xFFFFFFFFFFFFFFFFllu);
+	BigNum<10, 4>::digit_type remaind;
+	assert(e.div(7, &remaind) == 37 && remaind == 0);
+	// dump of compact length and digits
+	char dumped[16];
+	FILE *stream = tmpfile();
+	assert(stream != NULL);
+	BigNum<10, 2>(42).fdump(stream);
+	rewind(stream);
+	const char *res = fgets(dumped, sizeof(dumped), stream);
+	assert(res != NULL);
+	fclose(stream);
+	assert(strcmp(dumped, "2[4 2]") == 0);
+}
+
+void test_batch() {
+	typedef BigNum<0x100000000llu, 12> MyBigNum;
+	const size_t count = 1000;
+	std::vector<MyBigNum> a(count), b(count), c(count), x(count), y(count), gcd(count);
+	std::vector<MyBigNum> x_batch(count), y_batch(count), gcd_batch(count);
+	bool success[count], success_batch[count];
+	size_t solved = 0;
+	for (size_t i=0; i<count; ++i) {
+		a[i] = MyBigNum(xorshift()) * MyBigNum(xorshift() % 1000 + 1);
+		b[i] = MyBigNum(xorshift() | 1) * MyBigNum((xorshift() % 1000) | 1);
+		c[i] = MyBigNum(xorshift() % 1000) * MyBigNum(i % 7 + 1);
+		success[i] = MyBigNum::linear_diophantine(a[i], b[i], c[i], &x[i], &y[i]);
+		solved += success[i];
+		MyBigNum::extended_binary_euclidean(a[i], b[i], &x_batch[i], &y_batch[i], &gcd[i]);
+	}
+	assert(solved > 0 && solved < count);
+	for (unsigned int threads=1; threads<=5; threads+=2) {
+		BigNumThreadPool pool(threads);
+		assert(pool.size() == threads);
+		linear_diophantine_batch(pool, a.data(), b.data(), c.data(), count, x_batch.data(), y_batch.data(), success_batch);
+		for (size_t i=0; i<count; ++i) {
+			assert(success_batch[i] == success[i]);
+			if (!success[i]) continue;
+			assert(x_batch[i] == x[i] && y_batch[i] == y[i]);
+			assert(a[i].mul_wide(x[i]) == b[i].mul_wide(y[i]) + c[i]);
+		}
+		// pool is reused
+		extended_binary_euclidean_batch(pool, a.data(), b.data(), count, x_batch.data(), y_batch.data(), gcd_batch.data());
+		for (size_t i=0; i<count; ++i) {
+			assert(gcd_batch[i] == gcd[i]);
+			assert(a[i].mul_wide(x_batch[i]) == b[i].mul_wide(y_batch[i]) + gcd[i]);
+		}
+	}
+}
+
+void test_shared() {
+	typedef BigNum<0x100000000llu, 8> MyBigNum;
+	typedef BigNumShared<MyBigNum> MyShared;
+	MyBigNum p = 2;
+	p.pow_assign(127);
+	p -= 1;
+	MyShared a(p), b = a, zero;
+	assert(a.shares(b) && *b == p);
+	assert(zero.get() == 0 && zero.shares(MyShared()));
+	MyShared z;
+	z.mutate() += 5;
+	assert(*z == 5 && !z.shares(zero) && zero.get() == 0);
+	// copy-on-write
+	b.mutate() += 2;
+	assert(!a.shares(b));
+	assert(*a == p && *b == p + 2);
+	const MyBigNum *owned = &b.get();
+	b.mutate() -= 2;
+	assert(&b.get() == owned && *b == p);
+	
+	BigNumInternTable<MyBigNum> table;
+	MyShared c = table.intern(p), d = table.intern(*b), e = table.intern(p + 1);
+	assert(c.shares(d) && !c.shares(e) && !c.shares(a));
+	assert(table.size() == 2);
+	d.mutate() *= 3;
+	assert(*c == p && *d == p * 3);
+	assert(table.intern(p).shares(c));
+	
+	// concurrent interning of the same values
+	BigNumThreadPool pool(4);
+	MyShared interned[4][16];
+	pool.run([&](unsigned int index) {
+		for (unsigned int i=0; i<16; ++i) interned[index][i] = BigNumInternTable<MyBigNum>::global().intern(MyBigNum(i * 1000));
+	});
+	for (unsigned int t=1; t<4; ++t) {
+		for (unsigned int i=0; i<16; ++i) assert(interned[t][i].shares(interned[0][i]));
+	}
+	assert(BigNumInternTable<MyBigNum>::global().size() == 16);
+	
+	// copies released by other threads, then value is mutated in place
+	MyShared f(p);
+	std::vector<MyShared> copies(4, f);
+	assert(!f.shares(MyShared(p)) && copies[3].shares(f));
+	pool.run([&](unsigned int index) { copies[index] = MyShared(); });
+	const MyBigNum *stored = &f.get();
+	f.mutate() += 1;
+	assert(&f.get() == stored && *f == p + 1);
+	MyShared g = std::move(f);
+	assert(&g.get() == stored && f.get() == 0);
+	// interned values outlive their table
+	MyShared h;
+	{
+		BigNumInternTable<MyBigNum> local;
+		h = local.intern(p);
+	}
+	assert(*h == p);
+}
+
+void test_task() {
+	typedef BigNum<0x100000000llu, 686+1> MyBigNum;
+	const MyBigNum base = MyBigNum(xorshift()) * MyBigNum(xorshift());
+	for (len_type exp=0; exp<70; exp+=23) {
+		for (size_t budget=1; budget<=1000; budget*=10) {
+			MyBigNum::PowTask task(base, exp);
+			double progress = task.progress();
+			unsigned int steps = 0;
+			while (task.step(budget)) {
+				assert(task.progress() >= progress && task.progress() <= 1);
+				progress = task.progress();
+				++steps;
+			}
+			assert(task.done() && task.progress() == 1);
+			assert(task.value() == base.pow(exp));
+			if (exp > 1 && budget == 1) assert(steps > exp);
+		}
+	}
+	MyBigNum::PowTask zero(MyBigNum(0), 5);
+	while (zero.step(1)) {}
+	assert(zero.value() == 0);
+	
+	MyBigNum n, a, b, x, y, gcd, x_task, y_task, gcd_task;
+	n = 2000; a = n.pow(2000);
+	n = 1999; b = n.pow(1999);
+	MyBigNum::extended_binary_euclidean(a, b, &x, &y, &gcd);
+	MyBigNum::ExtendedBinaryEuclideanTask task(a, b);
+	double progress = 0;
+	unsigned int steps = 0;
+	while (task.step(100000)) {
+		assert(task.progress() >= progress && task.progress() < 1);
+		progress = task.progress();
+		++steps;
+	}
+	assert(steps > 100 && task.progress() == 1);
+	task.result(&x_task, &y_task, &gcd_task);
+	assert(x_task == x && y_task == y && gcd_task == gcd);
+	
+	// cancelled tasks do no more work
+	MyBigNum::ExtendedBinaryEuclideanTask cancelled(a, b);
+	assert(cancelled.step(100000));
+	progress = cancelled.progress();
+	cancelled.cancel();
+	assert(!cancelled.step(100000));
+	assert(cancelled.cancelled() && !cancelled.done() && cancelled.progress() == progress);
+	MyBigNum::PowTask cancelled_pow(base, 1000);
+	cancelled_pow.cancel();
+	assert(!cancelled_pow.step(1) && !cancelled_pow.done());
+}
+
 void suite() {
 	test_assign();
 	test_add();
@@ -232,6 +1046,24 @@ void suite() {
 	test_extended_binary_euclidean();
 	test_extended_binary_euclidean_large();
 	test_linear_diophantine();
+	test_binary_archive();
+	test_view();
+	test_scalar();
+	test_radix();
+	test_mul_columns();
+	test_signed();
+	test_divexact();
+	test_mul_wide();
+	test_constexpr();
+	test_to_chars();
+	test_accumulator();
+	test_rns();
+	test_prime();
+	test_batch_inverse();
+	test_storage();
+	test_batch();
+	test_shared();
+	test_task();
 }
 
 int main() {
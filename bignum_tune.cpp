@@ -0,0 +1,159 @@
+// measures crossover points of algorithms on the build host
+// and prints bignum_tuning.h with BigNumTuning specializations for TUNE_BASES
+#define BIGNUM_TUNING_STORAGE static inline
+#define BIGNUM_NO_TUNING_HEADER
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "bignum.h"
+
+#ifndef TUNE_BASES
+#  define TUNE_BASES 10000, 1000000000, 0x100000000llu
+#endif
+
+static uint64_t xorshift() {
+	static uint64_t x = 88172645463325252llu;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return x;
+}
+
+static double now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// minimal time of one call over several rounds of ~1ms
+template<typename F>
+static double measure(F f) {
+	double best = 0;
+	for (unsigned int round=0; round<5; ++round) {
+		unsigned int count = 0;
+		const double start = now_ns();
+		double elapsed;
+		do {
+			f();
+			++count;
+			elapsed = now_ns() - start;
+		} while (elapsed < 1e6);
+		const double t = elapsed / count;
+		if (round == 0 || t < best) best = t;
+	}
+	return best;
+}
+
+template<operation_type BASE, len_type N>
+static BigNum<BASE, N> random_bignum(const len_type len) {
+	typename BigNumLimb<BASE>::type digits[N];
+	for (len_type i=0; i<len; ++i) digits[i] = xorshift() % BASE;
+	if (len > 0 && digits[len-1] == 0) digits[len-1] = 1;
+	const BigNumView<BASE> v = {digits, len};
+	return BigNum<BASE, N>(v);
+}
+
+static volatile digit_type sink;
+
+static const len_type mul_sizes[] = {1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64};
+#define MUL_SIZES_COUNT (sizeof(mul_sizes) / sizeof(mul_sizes[0]))
+
+// threshold minimizing total time over mul_sizes
+template<operation_type BASE>
+static len_type tune_mul() {
+	typedef BigNum<BASE, 128> MyBigNum;
+	double rows[MUL_SIZES_COUNT], columns[MUL_SIZES_COUNT];
+	for (size_t i=0; i<MUL_SIZES_COUNT; ++i) {
+		const MyBigNum a = random_bignum<BASE, 128>(mul_sizes[i]);
+		const MyBigNum b = random_bignum<BASE, 128>(mul_sizes[i]);
+		BigNumTuning<BASE>::mul_comba_threshold = LEN_TYPE_MAX;
+		rows[i] = measure([&]{ sink = (a * b).view().len; });
+		BigNumTuning<BASE>::mul_comba_threshold = 1;
+		columns[i] = measure([&]{ sink = (a * b).view().len; });
+	}
+	// threshold mul_sizes[t] or never for t == MUL_SIZES_COUNT
+	size_t best_t = 0;
+	double best_cost = 0;
+	for (size_t t=0; t<=MUL_SIZES_COUNT; ++t) {
+		double cost = 0;
+		for (size_t i=0; i<MUL_SIZES_COUNT; ++i) cost += (i < t ? rows[i] : columns[i]);
+		if (t == 0 || cost < best_cost) {
+			best_t = t;
+			best_cost = cost;
+		}
+	}
+	return (best_t < MUL_SIZES_COUNT ? mul_sizes[best_t] : LEN_TYPE_MAX);
+}
+
+static const len_type radix_thresholds[] = {4, 8, 16, 32, 64, 128};
+#define RADIX_THRESHOLDS_COUNT (sizeof(radix_thresholds) / sizeof(radix_thresholds[0]))
+#define RADIX_SOURCE_LEN 256
+
+// source base must not be a power of BASE or vice versa
+template<operation_type BASE, operation_type B>
+static len_type tune_radix_from() {
+	static_assert(!exact_pow_constexpr(B, BASE) && !exact_pow_constexpr(BASE, B), "");
+	constexpr len_type N = RADIX_SOURCE_LEN * (B > BASE ? log_floor_constexpr(BASE, B) + 1 : 1) + 2;
+	typedef BigNum<BASE, N> MyBigNum;
+	const BigNum<B, RADIX_SOURCE_LEN> small = random_bignum<B, RADIX_SOURCE_LEN>(RADIX_SOURCE_LEN / 4);
+	const BigNum<B, RADIX_SOURCE_LEN> large = random_bignum<B, RADIX_SOURCE_LEN>(RADIX_SOURCE_LEN);
+	len_type best = radix_thresholds[0];
+	double best_cost = 0;
+	for (size_t t=0; t<RADIX_THRESHOLDS_COUNT; ++t) {
+		BigNumTuning<BASE>::radix_dc_threshold = radix_thresholds[t];
+		const double cost =
+			measure([&]{ sink = MyBigNum(small).view().len; }) +
+			measure([&]{ sink = MyBigNum(large).view().len; });
+		if (t == 0 || cost < best_cost) {
+			best = radix_thresholds[t];
+			best_cost = cost;
+		}
+	}
+	return best;
+}
+
+template<operation_type BASE>
+static len_type tune_radix() {
+	if constexpr (exact_pow_constexpr(2, BASE)) {
+		return tune_radix_from<BASE, 1000000000>();
+	} else {
+		return tune_radix_from<BASE, 0x100000000llu>();
+	}
+}
+
+static void print_len(const char *name, const len_type value) {
+	if (value == LEN_TYPE_MAX) {
+		printf("\tstatic constexpr len_type %s = LEN_TYPE_MAX;\n", name);
+	} else {
+		printf("\tstatic constexpr len_type %s = %" PRIuFAST16 ";\n", name, value);
+	}
+}
+
+template<operation_type BASE>
+static void tune_base() {
+	const len_type mul_comba_threshold = tune_mul<BASE>();
+	BigNumTuning<BASE>::mul_comba_threshold = mul_comba_threshold;
+	const len_type radix_dc_threshold = tune_radix<BASE>();
+	printf("\ntemplate<>\nstruct BigNumTuning<%" PRIuFAST64 "llu> {\n", BASE);
+	print_len("mul_comba_threshold", mul_comba_threshold);
+	print_len("radix_dc_threshold", radix_dc_threshold);
+	printf("};\n");
+	fflush(stdout);
+}
+
+template<operation_type... BASES>
+static void tune_bases() {
+	(tune_base<BASES>(), ...);
+}
+
+int main() {
+	printf("// generated by `make tune`, do not edit\n");
+	printf("#ifndef BIGNUM_TUNING_H\n#define BIGNUM_TUNING_H\n");
+	tune_bases<TUNE_BASES>();
+	printf("\n#endif/*BIGNUM_TUNING_H*/\n");
+	return 0;
+}